@@ -0,0 +1,264 @@
+#include "Benchmark.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+
+#include "BlockedEngine.hpp"
+#include "DistributedEngine.hpp"
+
+namespace {
+
+/// The engines measured for throughput, in the order they are printed.
+const char *s_engines[] = {"sparse", "fixed", "hybrid", "compressed", "lut", "distributed", "ltl", "blocked"};
+
+/// The square game space sizes measured for throughput.
+const int s_sizes[] = {256, 1024};
+
+/// The size of the game space the strong scaling benchmark divides.
+constexpr int s_strong_size = 1024;
+
+/// The size of the block each worker of the weak scaling benchmark steps.
+constexpr int s_weak_size = 512;
+
+/// The size of the game space the temporal blocking benchmark steps, two
+/// generations of which are larger than the last level cache.
+constexpr int s_blocked_size = 16384;
+
+/// The depths of the passes of the temporal blocking benchmark.
+const int s_depths[] = {1, 2, 4, 8, 16, 32, 64};
+
+/// The time each measurement runs for.
+constexpr std::chrono::milliseconds s_budget(1000);
+
+/// The generations of each batch of the scaling benchmarks.
+constexpr std::uint64_t s_batch = 8;
+
+}
+
+Benchmark::Benchmark(const Options &options)
+    : m_density(options.soup > 0 ? options.soup : 0.3)
+    , m_seed(options.seed)
+    , m_threads(options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency()))
+    , m_population(0)
+{}
+
+int Benchmark::run()
+{
+    std::cout << std::fixed;
+
+    throughput();
+    strong_scaling();
+    weak_scaling();
+    temporal_blocking();
+
+    return 0;
+}
+
+void Benchmark::throughput()
+{
+    std::cout << "Throughput, " << m_threads << " workers\n"
+              << std::left << std::setw(14) << "Engine" << std::setw(10) << "Workload" << std::setw(12) << "Size"
+              << std::right << std::setw(16) << "Generations/s" << std::setw(14) << "ns/tile" << std::setw(12) << "KiB" << std::setw(10) << "B/tile" << "\n";
+
+    for (bool mixed : {false, true}) {
+        for (int size : s_sizes) {
+            for (const char *name : s_engines) {
+
+                std::unique_ptr<Engine> engine = create(name, size, size, m_threads, mixed);
+                if (!engine)
+                    continue;
+
+                std::vector<Tile> born;
+                std::vector<Tile> died;
+
+                // Track the population to report the memory per alive tile.
+                std::int64_t population = m_population;
+
+                double rate = measure([&]{
+                    born.clear();
+                    died.clear();
+                    engine->advance(born, died);
+                    population += std::int64_t(born.size()) - std::int64_t(died.size());
+                    return 1;
+                });
+
+                std::cout << std::left << std::setw(14) << name << std::setw(10) << (mixed ? "mixed" : "soup")
+                          << std::setw(12) << (std::to_string(size) + "x" + std::to_string(size))
+                          << std::right << std::setprecision(1) << std::setw(16) << rate
+                          << std::setprecision(3) << std::setw(14) << 1e9 / (rate * size * size)
+                          << std::setprecision(1) << std::setw(12) << engine->memory() / 1024.0
+                          << std::setw(10) << double(engine->memory()) / std::max<std::int64_t>(1, population) << "\n";
+            }
+        }
+    }
+
+    std::cout << "\n";
+}
+
+void Benchmark::strong_scaling()
+{
+    std::cout << "Strong scaling, distributed " << s_strong_size << "x" << s_strong_size << "\n"
+              << std::setw(8) << "Workers" << std::setw(16) << "Generations/s"
+              << std::setw(10) << "Speedup" << std::setw(12) << "Efficiency" << "\n";
+
+    double base = 0;
+
+    for (std::size_t workers : worker_counts()) {
+
+        std::unique_ptr<Engine> engine = create("distributed", s_strong_size, s_strong_size, workers);
+        if (!engine)
+            break;
+
+        auto &distributed = static_cast<DistributedEngine&>(*engine);
+        double rate = measure([&]{ distributed.run(s_batch); return s_batch; });
+
+        if (base == 0)
+            base = rate;
+
+        std::cout << std::setw(8) << distributed.workers()
+                  << std::setprecision(1) << std::setw(16) << rate
+                  << std::setprecision(2) << std::setw(10) << rate / base
+                  << std::setw(11) << 100 * rate / base / distributed.workers() << "%\n";
+    }
+
+    std::cout << "\n";
+}
+
+void Benchmark::weak_scaling()
+{
+    std::cout << "Weak scaling, distributed " << s_weak_size << "x" << s_weak_size << " per worker\n"
+              << std::setw(8) << "Workers" << std::setw(14) << "Size" << std::setw(16) << "Generations/s"
+              << std::setw(16) << "Mtiles/s" << std::setw(12) << "Efficiency" << "\n";
+
+    double base = 0;
+
+    for (std::size_t workers : worker_counts()) {
+
+        // A row of blocks, which the engine splits back into one per worker.
+        int width = s_weak_size * int(workers);
+        std::unique_ptr<Engine> engine = create("distributed", width, s_weak_size, workers);
+        if (!engine)
+            break;
+
+        auto &distributed = static_cast<DistributedEngine&>(*engine);
+        double rate = measure([&]{ distributed.run(s_batch); return s_batch; });
+
+        if (base == 0)
+            base = rate;
+
+        std::cout << std::setw(8) << distributed.workers()
+                  << std::setw(14) << (std::to_string(width) + "x" + std::to_string(s_weak_size))
+                  << std::setprecision(1) << std::setw(16) << rate
+                  << std::setw(16) << rate * width * s_weak_size / 1e6
+                  << std::setprecision(2) << std::setw(11) << 100 * rate / base << "%\n";
+    }
+
+    std::cout << "\n";
+}
+
+void Benchmark::temporal_blocking()
+{
+    std::cout << "Temporal blocking, blocked " << s_blocked_size << "x" << s_blocked_size << ", " << m_threads << " workers\n"
+              << std::setw(8) << "Depth" << std::setw(16) << "Generations/s" << std::setw(12) << "Gtiles/s"
+              << std::setw(10) << "Speedup" << std::setw(10) << "GB/s" << std::setw(16) << "MB/generation"
+              << std::setw(10) << "Halos" << "\n";
+
+    std::unique_ptr<Engine> engine = create("blocked", s_blocked_size, s_blocked_size, m_threads);
+    if (!engine)
+        return;
+
+    // The cost of a dense pass does not depend on the tiles, so every depth
+    // continues from the generation the last left.
+    auto &blocked = static_cast<BlockedEngine&>(*engine);
+    double tiles = double(s_blocked_size) * s_blocked_size;
+    double base = 0;
+
+    for (int depth : s_depths) {
+
+        blocked.depth(depth);
+
+        std::uint64_t traffic = blocked.traffic();
+        std::uint64_t updates = blocked.updates();
+        std::uint64_t generations = 0;
+
+        double rate = measure([&]{
+            blocked.run(depth);
+            generations += depth;
+            return depth;
+        });
+
+        if (base == 0)
+            base = rate;
+
+        double bytes = double(blocked.traffic() - traffic) / generations;
+        double work = double(blocked.updates() - updates) / (tiles * generations);
+
+        std::cout << std::setw(8) << depth
+                  << std::setprecision(1) << std::setw(16) << rate
+                  << std::setprecision(2) << std::setw(12) << rate * tiles / 1e9
+                  << std::setw(10) << rate / base
+                  << std::setprecision(1) << std::setw(10) << rate * bytes / 1e9
+                  << std::setprecision(2) << std::setw(16) << bytes / 1e6
+                  << std::setprecision(1) << std::setw(9) << 100 * (work - 1) << "%\n";
+    }
+
+    std::cout << "\n";
+}
+
+std::unique_ptr<Engine> Benchmark::create(const std::string &name, int width, int height, std::size_t workers, bool mixed)
+{
+    std::unique_ptr<Engine> engine = make_engine(name, width, height, workers);
+    if (!engine)
+        return nullptr;
+
+    std::mt19937 generator(m_seed);
+    std::bernoulli_distribution alive(m_density);
+    m_population = 0;
+
+    // A mixed soup only fills the centre sixteenth of the game space.
+    int left = mixed ? width * 3 / 8 : 0;
+    int top = mixed ? height * 3 / 8 : 0;
+
+    for (int y = top; y < height - top; y++) {
+        for (int x = left; x < width - left; x++) {
+            if (alive(generator)) {
+                engine->update(x, y, true);
+                m_population++;
+            }
+        }
+    }
+
+    return engine;
+}
+
+double Benchmark::measure(const std::function<std::uint64_t()> &batch)
+{
+    using namespace std::chrono;
+
+    std::uint64_t generations = 0;
+    steady_clock::time_point start = steady_clock::now();
+    steady_clock::duration elapsed;
+
+    do {
+        generations += batch();
+        elapsed = steady_clock::now() - start;
+    }
+    while (elapsed < s_budget);
+
+    return generations / duration_cast<duration<double>>(elapsed).count();
+}
+
+std::vector<std::size_t> Benchmark::worker_counts() const
+{
+    std::vector<std::size_t> counts;
+
+    for (std::size_t workers = 1; workers < m_threads; workers *= 2)
+        counts.push_back(workers);
+
+    counts.push_back(m_threads);
+    return counts;
+}
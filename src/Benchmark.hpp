@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Engine.hpp"
+#include "Options.hpp"
+
+/**
+ * @brief Measures the throughput of every engine, how the distributed engine
+ * scales with its number of workers, and how the blocked engine scales with
+ * the depth of its passes.
+ * 
+ * Each measurement starts from the same random soup and repeats whole batches
+ * of generations until a time budget is spent, so slow engines finish in
+ * bounded time and fast engines are measured over many generations.
+ */
+class Benchmark
+{
+public:
+
+    /**
+     * @brief Create the benchmark described by the options.
+     * @param options The command line options.
+     */
+    Benchmark(const Options &options);
+
+    /**
+     * @brief Run every benchmark and print the results.
+     * @return The exit code of the application.
+     */
+    int run();
+
+private:
+
+    /**
+     * @brief Print the generations per second, nanoseconds per tile, memory and
+     * memory per alive tile of every engine available for each game space size, on a soup filling the
+     * game space and on a soup only filling a hotspot in an empty game space.
+     */
+    void throughput();
+
+    /**
+     * @brief Print the rate of the distributed engine on a fixed game space as
+     * workers are added, and the speedup and efficiency over one worker.
+     */
+    void strong_scaling();
+
+    /**
+     * @brief Print the rate of the distributed engine as the game space grows
+     * with the workers, so each worker keeps the same block.
+     */
+    void weak_scaling();
+
+    /**
+     * @brief Print the rate of the blocked engine on a game space larger than
+     * the cache as the depth of its passes grows, with the bandwidth of its
+     * passes and the work stepping their halos adds.
+     */
+    void temporal_blocking();
+
+    /**
+     * @brief Create an engine by name, starting with the benchmark soup.
+     * 
+     * @param name The name of the engine.
+     * @param width The width of the grid in tiles.
+     * @param height The height of the grid in tiles.
+     * @param workers The number of workers of engines that have them.
+     * @param mixed If the soup only fills a hotspot in the centre.
+     * @return The engine, or null if it is not available.
+     */
+    std::unique_ptr<Engine> create(const std::string &name, int width, int height, std::size_t workers, bool mixed = false);
+
+    /**
+     * @brief Measure the rate of advancing in batches until the time budget is
+     * spent.
+     * 
+     * @param batch Advances a batch of generations, returning how many.
+     * @return The generations per second.
+     */
+    double measure(const std::function<std::uint64_t()> &batch);
+
+    /**
+     * @brief Get the worker counts to scale over, doubling from one up to the
+     * number of threads.
+     * @return The worker counts.
+     */
+    std::vector<std::size_t> worker_counts() const;
+
+    /// The probability of each tile starting alive.
+    double m_density;
+
+    /// The seed of the random starting tiles.
+    unsigned m_seed;
+
+    /// The most workers to scale to.
+    std::size_t m_threads;
+
+    /// The population of the engine last created.
+    std::int64_t m_population;
+};
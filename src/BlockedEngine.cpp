@@ -0,0 +1,264 @@
+#include "BlockedEngine.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <latch>
+
+namespace {
+
+/// Wrap a coordinate any distance outside a dimension back into it.
+inline int wrap(int a, int n)
+{
+    return (a % n + n) % n;
+}
+
+}
+
+BlockedEngine::BlockedEngine(int width, int height, int depth, std::size_t workers)
+    : Engine(width, height)
+    , m_words(width / 64)
+    , m_depth(std::clamp(depth, 1, s_max_depth))
+    , m_current(std::size_t(m_words) * height, 0)
+    , m_next(std::size_t(m_words) * height, 0)
+    , m_before()
+    , m_blocks()
+    , m_scratch()
+    , m_pool()
+    , m_traffic(0)
+    , m_updates(0)
+{
+    for (int top = 0; top < height; top += s_block_rows) {
+        for (int left = 0; left < m_words; left += s_block_words) {
+            m_blocks.push_back(Block {
+                left,
+                top,
+                std::min(s_block_words, m_words - left),
+                std::min(s_block_rows, height - top)
+            });
+        }
+    }
+
+    m_scratch.resize(std::clamp<std::size_t>(workers, 1, m_blocks.size()));
+
+    if (m_scratch.size() > 1)
+        m_pool = std::make_unique<ThreadPool>(m_scratch.size() - 1);
+}
+
+void BlockedEngine::advance(std::vector<Tile> &born, std::vector<Tile> &died)
+{
+    pass(1);
+
+    // The previous generation is left in the next generation's buffer.
+    changes(m_next, born, died);
+}
+
+void BlockedEngine::advance_batch(std::uint64_t generations, std::vector<Tile> &born, std::vector<Tile> &died)
+{
+    m_before = m_current;
+    run(generations);
+    changes(m_before, born, died);
+}
+
+void BlockedEngine::update(int x, int y, bool alive)
+{
+    std::uint64_t &word = m_current[std::size_t(y) * m_words + x / 64];
+    std::uint64_t bit = std::uint64_t(1) << (x % 64);
+
+    word = alive ? word | bit : word & ~bit;
+}
+
+void BlockedEngine::clear()
+{
+    std::fill(m_current.begin(), m_current.end(), 0);
+}
+
+std::size_t BlockedEngine::memory() const
+{
+    std::size_t memory = m_current.capacity() + m_next.capacity() + m_before.capacity();
+
+    for (const Scratch &scratch : m_scratch)
+        memory += scratch.current.capacity() + scratch.next.capacity();
+
+    return memory * sizeof(std::uint64_t);
+}
+
+void BlockedEngine::run(std::uint64_t generations)
+{
+    while (generations > 0) {
+        int depth = int(std::min<std::uint64_t>(m_depth, generations));
+        pass(depth);
+        generations -= depth;
+    }
+}
+
+bool BlockedEngine::alive(int x, int y) const
+{
+    return m_current[std::size_t(y) * m_words + x / 64] >> (x % 64) & 1;
+}
+
+void BlockedEngine::depth(int depth)
+{
+    m_depth = std::clamp(depth, 1, s_max_depth);
+}
+
+void BlockedEngine::pass(int depth)
+{
+    std::size_t workers = m_scratch.size();
+
+    // Worker i steps every workers'th block from block i.
+    auto blocks = [this, depth, workers](std::size_t i) {
+        for (std::size_t b = i; b < m_blocks.size(); b += workers)
+            step(m_blocks[b], depth, m_scratch[i]);
+    };
+
+    if (m_pool) {
+        std::latch done(workers - 1);
+
+        for (std::size_t i = 1; i < workers; i++) {
+            m_pool->submit([&blocks, i, &done] {
+                blocks(i);
+                done.count_down();
+            });
+        }
+
+        blocks(0);
+        done.wait();
+    }
+    else {
+        blocks(0);
+    }
+
+    m_current.swap(m_next);
+
+    // Each block reads its buffer once, and writes itself once.
+    for (const Block &block : m_blocks) {
+        std::uint64_t words = block.words + 2;
+        std::uint64_t rows = block.rows + 2 * depth;
+
+        m_traffic += sizeof(std::uint64_t) * (words * rows + std::uint64_t(block.words) * block.rows);
+
+        for (int g = 1; g <= depth; g++)
+            m_updates += 64 * words * (rows - 2 * g);
+    }
+}
+
+void BlockedEngine::step(const Block &block, int depth, Scratch &scratch)
+{
+    int words = block.words + 2;
+    int rows = block.rows + 2 * depth;
+
+    scratch.current.resize(std::size_t(words) * rows);
+    scratch.next.resize(std::size_t(words) * rows);
+
+    // Copy the block and its halo, which may wrap around the game space more
+    // than once when the game space is smaller than the halo.
+    for (int r = 0; r < rows; r++) {
+        const std::uint64_t *source = &m_current[std::size_t(wrap(block.top - depth + r, m_height)) * m_words];
+        std::uint64_t *destination = &scratch.current[std::size_t(r) * words];
+
+        for (int c = 0; c < words; c++)
+            destination[c] = source[wrap(block.left - 1 + c, m_words)];
+    }
+
+    // Each generation the tiles wrong for lack of neighbors beyond the buffer
+    // spread a tile inwards, so a row fewer is stepped at the top and bottom.
+    // To the sides they stay within the halo words up to s_max_depth.
+    for (int g = 1; g <= depth; g++) {
+        if (m_rule == s_conway)
+            generation<true>(scratch.current.data(), scratch.next.data(), words, g, rows - g);
+        else
+            generation<false>(scratch.current.data(), scratch.next.data(), words, g, rows - g);
+
+        scratch.current.swap(scratch.next);
+    }
+
+    for (int r = 0; r < block.rows; r++) {
+        const std::uint64_t *source = &scratch.current[std::size_t(depth + r) * words + 1];
+        std::uint64_t *destination = &m_next[std::size_t(block.top + r) * m_words + block.left];
+
+        std::copy(source, source + block.words, destination);
+    }
+}
+
+void BlockedEngine::changes(const std::vector<std::uint64_t> &previous, std::vector<Tile> &born, std::vector<Tile> &died) const
+{
+    for (std::size_t i = 0; i < m_current.size(); i++) {
+        std::uint64_t now = m_current[i];
+
+        for (std::uint64_t changed = now ^ previous[i]; changed; changed &= changed - 1) {
+            int bit = std::countr_zero(changed);
+            Tile tile {int(i % m_words) * 64 + bit, int(i / m_words)};
+            (now >> bit & 1 ? born : died).push_back(tile);
+        }
+    }
+}
+
+template<bool Conway>
+void BlockedEngine::generation(const std::uint64_t *current, std::uint64_t *next, int words, int first, int last) const
+{
+    // The tiles to the left and right of each tile of a word, taking the
+    // tiles at the ends from the adjacent words, and dead tiles beyond the
+    // buffer.
+    auto left = [](const std::uint64_t *row, int c) {
+        return row[c] << 1 | (c > 0 ? row[c - 1] >> 63 : 0);
+    };
+
+    auto right = [words](const std::uint64_t *row, int c) {
+        return row[c] >> 1 | (c + 1 < words ? row[c + 1] << 63 : 0);
+    };
+
+    for (int r = first; r < last; r++) {
+
+        const std::uint64_t *above = &current[std::size_t(r - 1) * words];
+        const std::uint64_t *row = &current[std::size_t(r) * words];
+        const std::uint64_t *below = &current[std::size_t(r + 1) * words];
+        std::uint64_t *out = &next[std::size_t(r) * words];
+
+        for (int c = 0; c < words; c++) {
+
+            // Add the eight neighbors of every tile of the word at once with
+            // full adders, into the four bit planes of the count.
+            auto add = [](std::uint64_t a, std::uint64_t b, std::uint64_t d, std::uint64_t &sum, std::uint64_t &carry) {
+                std::uint64_t partial = a ^ b;
+                sum = partial ^ d;
+                carry = (a & b) | (partial & d);
+            };
+
+            std::uint64_t sum0, carry0, sum1, carry1, sum2, carry2;
+            add(left(above, c), above[c], right(above, c), sum0, carry0);
+            add(left(row, c), right(row, c), left(below, c), sum1, carry1);
+            add(below[c], right(below, c), 0, sum2, carry2);
+
+            std::uint64_t ones, twos_a, twos, fours_a, fours_b, fours, eights;
+            add(sum0, sum1, sum2, ones, twos_a);
+            add(carry0, carry1, carry2, twos, fours_a);
+            add(twos, twos_a, 0, twos, fours_b);
+            add(fours_a, fours_b, 0, fours, eights);
+
+            std::uint64_t alive = row[c];
+
+            if constexpr (Conway) {
+                out[c] = ~eights & ~fours & twos & (ones | alive);
+                continue;
+            }
+
+            std::uint64_t count[4] = {ones, twos, fours, eights};
+            std::uint64_t state = 0;
+
+            for (int n = 0; n <= 8; n++) {
+                bool birth = m_rule.birth >> n & 1;
+                bool survival = m_rule.survival >> n & 1;
+                if (!birth && !survival)
+                    continue;
+
+                std::uint64_t equal = ~std::uint64_t(0);
+                for (int bit = 0; bit < 4; bit++)
+                    equal &= n >> bit & 1 ? count[bit] : ~count[bit];
+
+                state |= equal & (birth && survival ? ~std::uint64_t(0) : birth ? ~alive : alive);
+            }
+
+            out[c] = state;
+        }
+    }
+}
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Engine.hpp"
+#include "ThreadPool.hpp"
+
+/**
+ * @brief An engine advancing several generations per pass over the game
+ * space, a bit per tile, so dense game spaces larger than the cache are not
+ * bound by memory bandwidth.
+ * 
+ * An engine stepping one generation per pass streams the whole game space
+ * through memory every generation. Instead each pass copies a block of rows
+ * and words, with a halo of the depth in rows above and below and a word to
+ * either side, into a buffer that fits the cache. The buffer is advanced the
+ * depth in generations, each generation stepping one row fewer at the top and
+ * bottom, as the tiles nearest the edges have neighbors missing from the
+ * buffer. The tiles left correct are the block, which is written to the next
+ * generation. The game space is then read and written once per depth of
+ * generations, at the cost of stepping the halos too.
+ * 
+ * Blocks only read the current generation and write the next, so they are
+ * stepped in parallel. A row must be a whole number of words, and the depth
+ * is at most a word, the width of the halo to either side.
+ */
+class BlockedEngine : public Engine
+{
+public:
+
+    /// The deepest pass, which the halo of a word to either side allows.
+    static constexpr int s_max_depth = 64;
+
+    /// The depth of passes by default.
+    static constexpr int s_default_depth = 8;
+
+    /**
+     * @brief Create an engine with an empty game space.
+     * 
+     * @param width The width of the grid in tiles, a multiple of 64.
+     * @param height The height of the grid in tiles.
+     * @param depth The generations each pass of run() advances.
+     * @param workers The number of blocks stepped in parallel.
+     */
+    BlockedEngine(int width, int height, int depth, std::size_t workers);
+
+    /**
+     * @brief Advances the game space by one generation, in a pass of depth
+     * one.
+     * 
+     * @param born Appended with each tile that became alive.
+     * @param died Appended with each tile that died.
+     */
+    void advance(std::vector<Tile> &born, std::vector<Tile> &died) override;
+
+    void update(int x, int y, bool alive) override;
+    void clear() override;
+
+    std::string name() const override {
+        return "blocked";
+    }
+
+    std::size_t memory() const override;
+
+    /**
+     * @brief Advances many generations in passes of the depth, reporting the
+     * tiles that differ from before them.
+     * 
+     * @param generations The number of generations.
+     * @param born Appended with each tile alive after but not before.
+     * @param died Appended with each tile alive before but not after.
+     */
+    void advance_batch(std::uint64_t generations, std::vector<Tile> &born, std::vector<Tile> &died) override;
+
+    /**
+     * @brief Advance many generations without recording changes, in passes of
+     * the depth.
+     * 
+     * @param generations The number of generations.
+     */
+    void run(std::uint64_t generations);
+
+    /**
+     * @brief Get if a tile is alive.
+     * 
+     * @param x The x position in the grid.
+     * @param y The y position in the grid.
+     * @return If the tile is alive.
+     */
+    bool alive(int x, int y) const;
+
+    /**
+     * @brief Get the generations each pass of run() and advance_batch()
+     * advances.
+     * @return The depth.
+     */
+    int depth() const override {
+        return m_depth;
+    }
+
+    /**
+     * @brief Set the generations each pass of run() and advance_batch()
+     * advances.
+     * @param depth The depth, clamped between one and s_max_depth.
+     */
+    void depth(int depth);
+
+    /**
+     * @brief Get the bytes passes have read from and written to the game
+     * space since construction.
+     * @return The bytes.
+     */
+    inline std::uint64_t traffic() const {
+        return m_traffic;
+    }
+
+    /**
+     * @brief Get the tile updates passes have computed since construction,
+     * including those of halos.
+     * @return The tile updates.
+     */
+    inline std::uint64_t updates() const {
+        return m_updates;
+    }
+
+private:
+
+    /// The words of a row of a block.
+    static constexpr int s_block_words = 16;
+
+    /// The rows of a block.
+    static constexpr int s_block_rows = 64;
+
+    /// A block of the game space.
+    struct Block {
+
+        /// The first word of the rows of the block.
+        int left;
+
+        /// The first row of the block.
+        int top;
+
+        /// The words of each row of the block.
+        int words;
+
+        /// The rows of the block.
+        int rows;
+    };
+
+    /// The buffers a worker advances a block in.
+    struct Scratch {
+
+        /// The generation being read, and the generation being written.
+        std::vector<std::uint64_t> current;
+        std::vector<std::uint64_t> next;
+    };
+
+    /**
+     * @brief Advance every block a number of generations into the next
+     * generation, and swap the generations.
+     * @param depth The generations, at most s_max_depth.
+     */
+    void pass(int depth);
+
+    /**
+     * @brief Advance a block a number of generations.
+     * 
+     * @param block The block.
+     * @param depth The generations.
+     * @param scratch The buffers of the worker.
+     */
+    void step(const Block &block, int depth, Scratch &scratch);
+
+    /**
+     * @brief Report the tiles that differ between a previous generation and
+     * the current generation.
+     * 
+     * @param previous The previous generation.
+     * @param born Appended with each tile alive now but not before.
+     * @param died Appended with each tile alive before but not now.
+     */
+    void changes(const std::vector<std::uint64_t> &previous, std::vector<Tile> &born, std::vector<Tile> &died) const;
+
+    /**
+     * @brief Advance the rows of a buffer by one generation.
+     * 
+     * @tparam Conway If the rule is Conway's, which is compared directly
+     * instead of looked up in the rule's masks.
+     * @param current The rows read.
+     * @param next The rows written.
+     * @param words The words of each row of the buffer.
+     * @param first The first row written.
+     * @param last The row after the last row written.
+     */
+    template<bool Conway>
+    void generation(const std::uint64_t *current, std::uint64_t *next, int words, int first, int last) const;
+
+    /// The words of each row.
+    int m_words;
+
+    /// The generations each pass of run() advances.
+    int m_depth;
+
+    /// The tiles of the current generation, a bit per tile, row major.
+    std::vector<std::uint64_t> m_current;
+
+    /// The tiles of the next generation.
+    std::vector<std::uint64_t> m_next;
+
+    /// The tiles before a batch, to report the tiles differing after it.
+    std::vector<std::uint64_t> m_before;
+
+    /// The blocks, in row major order.
+    std::vector<Block> m_blocks;
+
+    /// The buffers of each worker.
+    std::vector<Scratch> m_scratch;
+
+    /// Workers stepping the blocks with the calling thread, or null with one
+    /// worker.
+    std::unique_ptr<ThreadPool> m_pool;
+
+    /// The bytes passes have read and written.
+    std::uint64_t m_traffic;
+
+    /// The tile updates passes have computed.
+    std::uint64_t m_updates;
+};
@@ -0,0 +1,141 @@
+#include "Client.hpp"
+
+Client::Client()
+    : m_socket()
+    , m_selector()
+    , m_packet()
+    , m_pending(false)
+    , m_width(0)
+    , m_height(0)
+    , m_generation(0)
+    , m_tiles()
+{}
+
+bool Client::connect(const std::string &host, unsigned short port)
+{
+    if (m_socket.connect(host, port, sf::seconds(5)) != sf::Socket::Done) {
+        return false;
+    }
+
+    // The first message is always a keyframe. Read the size of the game space
+    // from a copy, so the keyframe is applied from the start on first receive.
+    if (m_socket.receive(m_packet) != sf::Socket::Done) {
+        m_socket.disconnect();
+        return false;
+    }
+
+    sf::Packet header = m_packet;
+    MessageType type;
+
+    if (!read_header(header, type) || type != MessageType::KEYFRAME) {
+        m_socket.disconnect();
+        return false;
+    }
+
+    m_pending = true;
+    m_socket.setBlocking(false);
+    m_selector.add(m_socket);
+
+    return true;
+}
+
+bool Client::receive(GameOfLife &model, sf::Time timeout, bool &applied)
+{
+    applied = false;
+
+    if (m_pending) {
+        m_pending = false;
+        applied = apply(model);
+    }
+
+    if (!m_selector.wait(timeout)) {
+        return true;
+    }
+
+    // Apply everything that has arrived.
+    for (;;) {
+        sf::Socket::Status status = m_socket.receive(m_packet);
+
+        if (status == sf::Socket::Done) {
+            if (!apply(model)) {
+                m_socket.disconnect();
+                return false;
+            }
+
+            applied = true;
+        }
+        else if (status == sf::Socket::NotReady || status == sf::Socket::Partial) {
+            return true;
+        }
+        else {
+            return false;
+        }
+    }
+}
+
+bool Client::read_header(sf::Packet &packet, MessageType &type)
+{
+    sf::Uint8 message = 0;
+    sf::Uint32 width = 0;
+    sf::Uint32 height = 0;
+    sf::Uint64 generation = 0;
+
+    if (!(packet >> message >> width >> height >> generation)) {
+        return false;
+    }
+
+    if (message > sf::Uint8(MessageType::DELTA) || width < 3 || height < 3) {
+        return false;
+    }
+
+    // The size of the game space never changes after the first keyframe.
+    if (m_width != 0 && (int(width) != m_width || int(height) != m_height)) {
+        return false;
+    }
+
+    type = MessageType(message);
+    m_width = width;
+    m_height = height;
+    m_generation = generation;
+
+    return true;
+}
+
+bool Client::apply(GameOfLife &model)
+{
+    MessageType type;
+    if (!read_header(m_packet, type)) {
+        return false;
+    }
+
+    if (type == MessageType::KEYFRAME) {
+        if (!read_tiles(m_packet, m_tiles, m_width, m_height)) {
+            return false;
+        }
+
+        model.clear();
+        for (Tile tile : m_tiles) {
+            model.place(tile.x, tile.y);
+        }
+
+        return true;
+    }
+
+    if (!read_tiles(m_packet, m_tiles, m_width, m_height)) {
+        return false;
+    }
+
+    for (Tile tile : m_tiles) {
+        model.place(tile.x, tile.y);
+    }
+
+    if (!read_tiles(m_packet, m_tiles, m_width, m_height)) {
+        return false;
+    }
+
+    for (Tile tile : m_tiles) {
+        model.remove(tile.x, tile.y);
+    }
+
+    return true;
+}
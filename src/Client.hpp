@@ -0,0 +1,112 @@
+#pragma once
+
+#include <SFML/Network.hpp>
+#include <string>
+#include <vector>
+
+#include "GameOfLife.hpp"
+#include "Stream.hpp"
+
+/**
+ * @brief Observes the stream of a game of life served by Server, applying it
+ * to a local game of life that is never advanced.
+ */
+class Client
+{
+public:
+
+    /**
+     * @brief Create a disconnected client.
+     */
+    Client();
+
+    /**
+     * @brief Connect to a server and wait for its first keyframe, which gives
+     * the size of the game space.
+     * 
+     * @param host The address of the server.
+     * @param port The TCP port of the server.
+     * @return If the connection succeeded and the first keyframe was received.
+     */
+    bool connect(const std::string &host, unsigned short port);
+
+    /**
+     * @brief Apply the messages received within a timeout to a game of life,
+     * which must have the width and height of the served game space.
+     * 
+     * @param model The game of life to update.
+     * @param timeout The longest time to wait for a message.
+     * @param applied Set if a message was applied, which only ever places and
+     * removes tiles, so leaves the generation of the game of life unchanged.
+     * @return If the client is still connected.
+     */
+    bool receive(GameOfLife &model, sf::Time timeout, bool &applied);
+
+    /**
+     * @brief Get the width of the served game space.
+     * @return The width of the served game space.
+     */
+    inline int width() const {
+        return m_width;
+    }
+
+    /**
+     * @brief Get the height of the served game space.
+     * @return The height of the served game space.
+     */
+    inline int height() const {
+        return m_height;
+    }
+
+    /**
+     * @brief Get the generation of the last message applied.
+     * @return The generation.
+     */
+    inline std::uint64_t generation() const {
+        return m_generation;
+    }
+
+private:
+
+    /**
+     * @brief Read the header of a packet, checking the size of the game space
+     * if it is known.
+     * 
+     * @param packet The packet to read.
+     * @param type Assigned the message type.
+     * @return If the header is valid.
+     */
+    bool read_header(sf::Packet &packet, MessageType &type);
+
+    /**
+     * @brief Apply the received packet to a game of life.
+     * 
+     * @param model The game of life to update.
+     * @return If the packet is valid.
+     */
+    bool apply(GameOfLife &model);
+
+    /// The connection to the server.
+    sf::TcpSocket m_socket;
+
+    /// Selector waiting for the connection to receive.
+    sf::SocketSelector m_selector;
+
+    /// The last packet received.
+    sf::Packet m_packet;
+
+    /// If the first keyframe is received but not yet applied.
+    bool m_pending;
+
+    /// The width of the served game space.
+    int m_width;
+
+    /// The height of the served game space.
+    int m_height;
+
+    /// The generation of the last message.
+    std::uint64_t m_generation;
+
+    /// Tiles read from a message.
+    std::vector<Tile> m_tiles;
+};
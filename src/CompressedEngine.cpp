@@ -0,0 +1,374 @@
+#include "CompressedEngine.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <climits>
+
+namespace {
+
+/// The columns of a container.
+constexpr int s_container_size = 1 << 16;
+
+/// The 16 bit words of a bitmap container.
+constexpr std::size_t s_bitmap_words = s_container_size / 16;
+
+}
+
+CompressedEngine::CompressedEngine(int width, int height)
+    : Engine(width, height)
+    , m_rows()
+    , m_next()
+    , m_cached_rows({-1, -1, -1})
+    , m_cached_uses({0, 0, 0})
+    , m_cache()
+    , m_uses(0)
+    , m_candidates()
+    , m_columns()
+    , m_stepped()
+{}
+
+void CompressedEngine::advance(std::vector<Tile> &born, std::vector<Tile> &died)
+{
+    // Only rows within one of an alive tile can change.
+    m_candidates.clear();
+
+    for (const Row &row : m_rows) {
+        m_candidates.push_back((row.y - 1 + m_height) % m_height);
+        m_candidates.push_back(row.y);
+        m_candidates.push_back((row.y + 1) % m_height);
+    }
+
+    std::sort(m_candidates.begin(), m_candidates.end());
+    m_candidates.erase(std::unique(m_candidates.begin(), m_candidates.end()), m_candidates.end());
+
+    m_next.clear();
+
+    for (int y : m_candidates) {
+
+        const std::vector<int> &above = decoded((y - 1 + m_height) % m_height);
+        const std::vector<int> &middle = decoded(y);
+        const std::vector<int> &below = decoded((y + 1) % m_height);
+
+        step(above, middle, below, m_stepped);
+
+        // Merge the sorted rows to find the tiles that changed.
+        auto current = middle.begin();
+        auto next = m_stepped.begin();
+
+        while (current != middle.end() || next != m_stepped.end()) {
+            if (next == m_stepped.end() || (current != middle.end() && *current < *next))
+                died.push_back(Tile(*current++, y));
+            else if (current == middle.end() || *next < *current)
+                born.push_back(Tile(*next++, y));
+            else
+                current++, next++;
+        }
+
+        if (!m_stepped.empty()) {
+            m_next.push_back(Row {y, {}});
+            encode(m_stepped, m_next.back());
+        }
+    }
+
+    m_rows.swap(m_next);
+    m_cached_rows.fill(-1);
+}
+
+void CompressedEngine::update(int x, int y, bool alive)
+{
+    Row *row = find(y);
+
+    if (!row) {
+        if (!alive)
+            return;
+
+        auto position = std::lower_bound(m_rows.begin(), m_rows.end(), y, [](const Row &row, int y) {
+            return row.y < y;
+        });
+        row = &*m_rows.insert(position, Row {y, {}});
+    }
+
+    std::uint16_t key = std::uint16_t(x / s_container_size);
+    std::uint16_t column = std::uint16_t(x % s_container_size);
+
+    auto container = std::lower_bound(row->containers.begin(), row->containers.end(), key, [](const Container &container, std::uint16_t key) {
+        return container.key < key;
+    });
+
+    if (container == row->containers.end() || container->key != key) {
+        if (!alive)
+            return;
+
+        container = row->containers.insert(container, Container {key, Type::ARRAY, {}});
+    }
+
+    std::vector<std::uint16_t> &data = container->data;
+
+    if (container->type == Type::ARRAY) {
+        auto position = std::lower_bound(data.begin(), data.end(), column);
+        bool found = position != data.end() && *position == column;
+
+        if (alive && !found)
+            data.insert(position, column);
+        else if (!alive && found)
+            data.erase(position);
+
+        // Arrays shrinking from a converted bitmap give back their words.
+        if (data.size() < data.capacity() / 4)
+            data.shrink_to_fit();
+    }
+    else if (container->type == Type::BITMAP) {
+        std::uint16_t bit = std::uint16_t(1 << (column % 16));
+        data[column / 16] = alive ? data[column / 16] | bit : data[column / 16] & ~bit;
+    }
+
+    // A bitmap emptied down to what an array stores in fewer words is
+    // converted, and erased once empty.
+    bool shrunk = false;
+    if (container->type == Type::BITMAP && !alive) {
+        std::size_t population = 0;
+        for (std::uint16_t word : data)
+            population += std::popcount(word);
+
+        shrunk = population <= s_bitmap_words;
+    }
+
+    // Runs are edited decoded, since an edit can split or join them, and
+    // arrays larger than a bitmap are converted.
+    if (container->type == Type::RUNS || data.size() > s_bitmap_words || shrunk) {
+        std::vector<int> columns;
+        decode(*container, columns);
+
+        if (container->type == Type::RUNS) {
+            auto position = std::lower_bound(columns.begin(), columns.end(), x);
+            bool found = position != columns.end() && *position == x;
+
+            if (alive && !found)
+                columns.insert(position, x);
+            else if (!alive && found)
+                columns.erase(position);
+        }
+
+        *container = encode(key, columns.data(), columns.data() + columns.size());
+    }
+
+    if (container->data.empty())
+        row->containers.erase(container);
+
+    if (row->containers.empty())
+        m_rows.erase(m_rows.begin() + (row - m_rows.data()));
+
+    m_cached_rows.fill(-1);
+}
+
+void CompressedEngine::clear()
+{
+    m_rows.clear();
+    m_cached_rows.fill(-1);
+}
+
+std::size_t CompressedEngine::memory() const
+{
+    std::size_t bytes = m_rows.capacity() * sizeof(Row);
+
+    for (const Row &row : m_rows) {
+        bytes += row.containers.capacity() * sizeof(Container);
+
+        for (const Container &container : row.containers)
+            bytes += container.data.capacity() * sizeof(std::uint16_t);
+    }
+
+    return bytes;
+}
+
+void CompressedEngine::step(
+    const std::vector<int> &above,
+    const std::vector<int> &middle,
+    const std::vector<int> &below,
+    std::vector<int> &next
+) {
+    // Merge the three rows into the sum of each column with an alive tile.
+    m_columns.clear();
+
+    std::size_t a = 0;
+    std::size_t m = 0;
+    std::size_t b = 0;
+
+    while (a < above.size() || m < middle.size() || b < below.size()) {
+        int x = INT_MAX;
+        if (a < above.size()) x = std::min(x, above[a]);
+        if (m < middle.size()) x = std::min(x, middle[m]);
+        if (b < below.size()) x = std::min(x, below[b]);
+
+        Column column {x, 0, false};
+        if (a < above.size() && above[a] == x) column.sum++, a++;
+        if (m < middle.size() && middle[m] == x) column.sum++, m++, column.alive = true;
+        if (b < below.size() && below[b] == x) column.sum++, b++;
+
+        m_columns.push_back(column);
+    }
+
+    next.clear();
+
+    if (m_columns.empty())
+        return;
+
+    // The columns on each edge also neighbor the columns on the other edge,
+    // so they are repeated one past the opposite edge.
+    Column first = m_columns.front();
+    Column last = m_columns.back();
+
+    if (last.x == m_width - 1)
+        m_columns.insert(m_columns.begin(), Column {-1, last.sum, false});
+    if (first.x == 0)
+        m_columns.push_back(Column {m_width, first.sum, false});
+
+    // Every tile within one column of a column with an alive tile is stepped,
+    // in ascending order. Its neighbors are within two entries either side.
+    int stepped = INT_MIN;
+    int size = int(m_columns.size());
+
+    for (int i = 0; i < size; i++) {
+        for (int x = m_columns[i].x - 1; x <= m_columns[i].x + 1; x++) {
+
+            if (x <= stepped || x < 0 || x >= m_width)
+                continue;
+
+            stepped = x;
+
+            int n = 0;
+            bool alive = false;
+
+            for (int j = std::max(0, i - 2); j <= std::min(size - 1, i + 2); j++) {
+                if (m_columns[j].x >= x - 1 && m_columns[j].x <= x + 1)
+                    n += m_columns[j].sum;
+                if (m_columns[j].x == x)
+                    alive = m_columns[j].alive;
+            }
+
+            n -= alive;
+
+            if ((alive ? m_rule.survival : m_rule.birth) >> n & 1)
+                next.push_back(x);
+        }
+    }
+}
+
+const std::vector<int> &CompressedEngine::decoded(int y)
+{
+    m_uses++;
+
+    for (std::size_t i = 0; i < m_cache.size(); i++) {
+        if (m_cached_rows[i] == y) {
+            m_cached_uses[i] = m_uses;
+            return m_cache[i];
+        }
+    }
+
+    // Replace the least recently used row, which is never one of the three
+    // rows around the row being stepped.
+    std::size_t i = std::min_element(m_cached_uses.begin(), m_cached_uses.end()) - m_cached_uses.begin();
+    m_cached_rows[i] = y;
+    m_cached_uses[i] = m_uses;
+    m_cache[i].clear();
+
+    if (const Row *row = find(y))
+        for (const Container &container : row->containers)
+            decode(container, m_cache[i]);
+
+    return m_cache[i];
+}
+
+CompressedEngine::Row *CompressedEngine::find(int y)
+{
+    auto row = std::lower_bound(m_rows.begin(), m_rows.end(), y, [](const Row &row, int y) {
+        return row.y < y;
+    });
+
+    return row != m_rows.end() && row->y == y ? &*row : nullptr;
+}
+
+void CompressedEngine::decode(const Container &container, std::vector<int> &columns)
+{
+    int x = container.key * s_container_size;
+    const std::vector<std::uint16_t> &data = container.data;
+
+    switch (container.type) {
+    case Type::ARRAY:
+        for (std::uint16_t column : data)
+            columns.push_back(x + column);
+        break;
+
+    case Type::BITMAP:
+        for (std::size_t word = 0; word < data.size(); word++)
+            for (unsigned bits = data[word]; bits; bits &= bits - 1)
+                columns.push_back(x + int(word) * 16 + std::countr_zero(bits));
+        break;
+
+    case Type::RUNS:
+        for (std::size_t i = 0; i < data.size(); i += 2)
+            for (int column = data[i]; column <= data[i] + data[i + 1]; column++)
+                columns.push_back(x + column);
+        break;
+    }
+}
+
+CompressedEngine::Container CompressedEngine::encode(std::uint16_t key, const int *begin, const int *end)
+{
+    std::size_t count = end - begin;
+    std::size_t runs = 0;
+
+    for (const int *column = begin; column != end; column++)
+        if (column == begin || *column != column[-1] + 1)
+            runs++;
+
+    // The sizes of each encoding in 16 bit words.
+    std::size_t array = count;
+    std::size_t bitmap = s_bitmap_words;
+    std::size_t run = 2 * runs;
+
+    int x = key * s_container_size;
+    Container container {key, Type::ARRAY, {}};
+
+    if (array <= bitmap && array <= run) {
+        container.data.reserve(array);
+        for (const int *column = begin; column != end; column++)
+            container.data.push_back(std::uint16_t(*column - x));
+    }
+    else if (run <= bitmap) {
+        container.type = Type::RUNS;
+        container.data.reserve(run);
+
+        for (const int *column = begin; column != end; column++) {
+            if (column == begin || *column != column[-1] + 1)
+                container.data.insert(container.data.end(), {std::uint16_t(*column - x), 0});
+            else
+                container.data.back()++;
+        }
+    }
+    else {
+        container.type = Type::BITMAP;
+        container.data.assign(bitmap, 0);
+
+        for (const int *column = begin; column != end; column++)
+            container.data[(*column - x) / 16] |= std::uint16_t(1 << ((*column - x) % 16));
+    }
+
+    return container;
+}
+
+void CompressedEngine::encode(const std::vector<int> &columns, Row &row)
+{
+    row.containers.clear();
+
+    const int *begin = columns.data();
+    const int *end = begin + columns.size();
+
+    while (begin != end) {
+        int key = *begin / s_container_size;
+        const int *split = std::lower_bound(begin, end, (key + 1) * s_container_size);
+
+        row.containers.push_back(encode(std::uint16_t(key), begin, split));
+        begin = split;
+    }
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "Engine.hpp"
+
+/**
+ * @brief An engine storing each row of alive tiles as compressed containers,
+ * for very large game spaces with too many alive tiles for a hash set.
+ * 
+ * Each row is split into containers of 65536 columns, like a roaring bitmap.
+ * A container stores its alive columns as a sorted array, as a bitmap, or as
+ * runs of consecutive columns, whichever is smallest. Rows without alive
+ * tiles are not stored, so a tile costs a few bytes in a populated row.
+ * 
+ * Stepping streams the rows in order, decoding only the three rows around
+ * each row being stepped, and encodes each next row as soon as it is stepped.
+ */
+class CompressedEngine : public Engine
+{
+public:
+
+    /**
+     * @brief Create an engine with an empty game space.
+     * 
+     * @param width The width of the grid in tiles.
+     * @param height The height of the grid in tiles.
+     */
+    CompressedEngine(int width, int height);
+
+    void advance(std::vector<Tile> &born, std::vector<Tile> &died) override;
+    void update(int x, int y, bool alive) override;
+    void clear() override;
+
+    std::string name() const override {
+        return "compressed";
+    }
+
+    std::size_t memory() const override;
+
+private:
+
+    /// The encoding of a container.
+    enum class Type : std::uint8_t {
+
+        /// The sorted alive columns.
+        ARRAY,
+
+        /// A bit per column, sixteen columns to a word.
+        BITMAP,
+
+        /// The first column and length minus one of each run of alive columns.
+        RUNS
+    };
+
+    /// The alive tiles of 65536 columns of a row.
+    struct Container {
+
+        /// The columns of the container divided by 65536.
+        std::uint16_t key;
+
+        /// The encoding of the data.
+        Type type;
+
+        /// The encoded alive columns, relative to the first of the container.
+        std::vector<std::uint16_t> data;
+    };
+
+    /// A row with at least one alive tile.
+    struct Row {
+
+        /// The y position of the row.
+        int y;
+
+        /// The containers with at least one alive tile, in ascending keys.
+        std::vector<Container> containers;
+    };
+
+    /// The sum of the alive tiles of a column of three rows.
+    struct Column {
+        int x;
+        int sum;
+        bool alive;
+    };
+
+    /**
+     * @brief Step a row from its alive columns and those above and below.
+     * 
+     * @param above The sorted alive columns of the row above.
+     * @param middle The sorted alive columns of the row.
+     * @param below The sorted alive columns of the row below.
+     * @param next Assigned the sorted alive columns of the next generation.
+     */
+    void step(
+        const std::vector<int> &above,
+        const std::vector<int> &middle,
+        const std::vector<int> &below,
+        std::vector<int> &next
+    );
+
+    /**
+     * @brief Get the alive columns of a row, keeping the last three rows
+     * decoded.
+     * 
+     * @param y The y position of the row.
+     * @return The sorted alive columns, valid until three other rows are
+     * decoded.
+     */
+    const std::vector<int> &decoded(int y);
+
+    /**
+     * @brief Find a row.
+     * 
+     * @param y The y position of the row.
+     * @return The row, or null if it has no alive tiles.
+     */
+    Row *find(int y);
+
+    /**
+     * @brief Append the alive columns of a container.
+     * 
+     * @param container The container.
+     * @param columns Appended with its sorted alive columns.
+     */
+    static void decode(const Container &container, std::vector<int> &columns);
+
+    /**
+     * @brief Encode alive columns of the same container in its smallest type.
+     * 
+     * @param key The key of the container.
+     * @param begin The first sorted alive column, in the game space.
+     * @param end One past the last sorted alive column.
+     * @return The container.
+     */
+    static Container encode(std::uint16_t key, const int *begin, const int *end);
+
+    /**
+     * @brief Encode the sorted alive columns of a row.
+     * 
+     * @param columns The sorted alive columns.
+     * @param row Assigned the containers of the columns.
+     */
+    static void encode(const std::vector<int> &columns, Row &row);
+
+    /// The rows with alive tiles, in ascending y.
+    std::vector<Row> m_rows;
+
+    /// The rows of the next generation while stepping.
+    std::vector<Row> m_next;
+
+    /// The rows decoded by decoded(), and when each was last used.
+    std::array<int, 3> m_cached_rows;
+    std::array<std::uint64_t, 3> m_cached_uses;
+    std::array<std::vector<int>, 3> m_cache;
+    std::uint64_t m_uses;
+
+    /// The rows stepped this generation.
+    std::vector<int> m_candidates;
+
+    /// The column sums of the row being stepped.
+    std::vector<Column> m_columns;
+
+    /// The next alive columns of the row being stepped.
+    std::vector<int> m_stepped;
+};
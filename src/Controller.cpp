@@ -1,17 +1,44 @@
 #include "Controller.hpp"
 
+#include <cmath>
+#include <iostream>
+#include <limits>
 #include <vector>
 
 using namespace std::chrono;
 
-Controller::Controller()
+Controller::Controller(unsigned short serve, const std::string &journal)
+    : Controller(nullptr, serve, journal)
+{}
+
+Controller::Controller(std::unique_ptr<Client> client)
+    : Controller(std::move(client), 0, "")
+{}
+
+Controller::Controller(std::unique_ptr<Client> client, unsigned short serve, const std::string &journal)
     : m_view()
-    , m_model(m_view.width() / 20, m_view.height() / 20)
-    , m_model_delta(100ms)
-    , m_model_delta_minimum(1us)
-    , m_model_delta_maximum(2s)
-    , m_view_delta(1s / 60s)
+    , m_client(std::move(client))
+    , m_model(
+        m_client ? m_client->width() : m_view.width() / 20,
+        m_client ? m_client->height() : m_view.height() / 20
+    )
+    , m_server()
+    , m_journal()
+    , m_frames()
+    , m_packaged_generation(-1)
+    , m_packaged_region()
+    , m_target(10)
+    , m_target_minimum(0.5)
+    , m_target_maximum(1 << 20)
+    , m_batch_budget(5ms)
+    , m_paused_delta(16ms)
+    , m_view_delta(duration_cast<microseconds>(1s) / 60)
+    , m_frame_times("Frame time")
+    , m_latencies("Click to photon")
+    , m_edits()
     , m_paused(false)
+    , m_repackage(false)
+    , m_redraw(true)
     , m_iterations(0)
     , m_performance(0)
     , m_left(false)
@@ -19,14 +46,22 @@ Controller::Controller()
     , m_up(false)
     , m_down(false)
 {
-    // Add a gilder to the centre of the game space.
-    m_model.add_glider();
+    // Add a gilder to the centre of the game space, unless it is received.
+    if (!m_client)
+        m_model.add_glider();
+
+    if (serve)
+        m_server = std::make_unique<Server>(m_model, serve);
+
+    // A viewer's model only follows the server, so has nothing to journal.
+    if (!journal.empty() && !m_client)
+        m_journal = std::make_unique<Journal>(journal, m_model.width(), m_model.height(), m_target);
 
     m_view.set(m_model.width(), m_model.height());
 
     // Start the simulation thread first because the view thread depends on it.
     m_model_thread = std::jthread(
-        &Controller::simulation_thread,
+        m_client ? &Controller::client_thread : &Controller::simulation_thread,
         this,
         m_stop.get_token()
     );
@@ -38,34 +73,168 @@ Controller::Controller()
         m_stop.get_token()
     );
 
-    // Update the view with the initial state.
-    m_view.render(m_model.space());
-    m_view.display();
+    // The view thread displays the initial state from the first frame.
+}
+
+Controller::~Controller()
+{
+    m_stop.request_stop();
+
+    // Nothing changes the model once its thread has stopped, so the journal
+    // ends at its final generation.
+    m_model_thread.join();
+
+    // The view thread waits on and records into members declared after it,
+    // which are destroyed before it would be joined.
+    m_view_thread.join();
+
+    if (m_journal) {
+        JournalEntry entry {m_model.generation(), JournalEntry::Type::END};
+        entry.fingerprint = Journal::fingerprint(m_model);
+        journal(entry);
+    }
 }
 
 void Controller::simulation_thread(std::stop_token stop)
 {
     std::unique_lock<std::mutex> lock(m_model_condition_mutex);
 
-    for (;;) {
+    // Moving average of the time to advance one generation, used to size
+    // batches to the budget.
+    duration<double> step_cost = 0s;
 
-        m_model_condition.wait_until(
-            lock,
-            stop,
-            high_resolution_clock::now() + m_model_delta,
-            [&]{ return m_paused.load(); }
-        );
+    // The time the next generation is due when running at a finite target.
+    steady_clock::time_point due = steady_clock::now();
 
-        // Check for exit signal
-        if (stop.stop_requested())
-            break;
+    // The target the schedule was last calculated for.
+    double scheduled = m_target;
+
+    // The pause and target last journaled. Changes are journaled here between
+    // batches, stamped with the generation they take effect at, as a batch
+    // started before a key press runs to its end.
+    bool journaled_paused = m_paused;
+    double journaled_target = m_target;
+
+    while (!stop.stop_requested()) {
+
+        package();
+
+        if (m_server)
+            m_server->publish();
+
+        bool paused = m_paused;
+        double target = m_target;
 
-        // Catch spurious wakeups.
-        if (m_paused)
+        if (paused != journaled_paused) {
+            journaled_paused = paused;
+            journal(JournalEntry {
+                m_model.generation(),
+                paused ? JournalEntry::Type::PAUSE : JournalEntry::Type::RESUME
+            });
+        }
+
+        if (target != journaled_target) {
+            journaled_target = target;
+
+            JournalEntry entry {m_model.generation(), JournalEntry::Type::SPEED};
+            entry.target = target;
+            journal(entry);
+        }
+
+        if (paused) {
+            m_model_condition.wait_for(
+                lock,
+                stop,
+                m_paused_delta,
+                [&]{ return !m_paused.load(); }
+            );
+
+            due = steady_clock::now();
             continue;
+        }
 
-        m_model.advance();
-        m_iterations++;
+        steady_clock::time_point now = steady_clock::now();
+
+        // Start a new schedule from now when the speed changes.
+        if (target != scheduled) {
+            scheduled = target;
+            due = now;
+        }
+
+        // The most generations that fit in the budget. The first generation
+        // runs alone to measure its cost.
+        std::size_t batch = 1;
+        if (step_cost > 0s)
+            batch = static_cast<std::size_t>(std::max(1.0, m_batch_budget / step_cost));
+
+        if (!std::isinf(target)) {
+
+            duration<double> period(1.0 / target);
+
+            // Sleep until the next generation is due, or the schedule changes.
+            if (now < due) {
+                m_model_condition.wait_until(
+                    lock,
+                    stop,
+                    due,
+                    [&]{ return m_paused.load() || m_target != target; }
+                );
+                continue;
+            }
+
+            // Run every generation that is due, within the budget. Fall behind
+            // rather than accumulate a backlog if the model is too slow.
+            std::size_t behind = 1 + (now - due) / period;
+            batch = std::min(batch, behind);
+
+            if (batch < behind)
+                due = now;
+            else
+                due += duration_cast<steady_clock::duration>(batch * period);
+        }
+
+        // Run the batch without the condition mutex so that pausing and speed
+        // changes are never blocked by the model.
+        lock.unlock();
+
+        steady_clock::time_point start = steady_clock::now();
+        for (std::size_t i = 0; i < batch; i++) {
+            m_model.advance();
+
+            if (m_server)
+                m_server->publish();
+        }
+        duration<double> elapsed = steady_clock::now() - start;
+
+        lock.lock();
+
+        duration<double> cost = elapsed / batch;
+        step_cost = step_cost > 0s ? (step_cost * 7 + cost) / 8 : cost;
+
+        m_iterations += batch;
+    }
+}
+
+void Controller::client_thread(std::stop_token stop)
+{
+    // Once disconnected, keep displaying the last state received.
+    bool connected = true;
+
+    while (!stop.stop_requested()) {
+
+        bool applied = false;
+
+        if (connected)
+            connected = m_client->receive(m_model, sf::milliseconds(16), applied);
+        else
+            std::this_thread::sleep_for(m_paused_delta);
+
+        // The model is only edited by the client and never advanced, so its
+        // generation does not show that it changed.
+        if (applied)
+            m_repackage = true;
+
+        package();
     }
 }
 
@@ -73,22 +242,99 @@ void Controller::view_thread(std::stop_token stop)
 {
     std::unique_lock<std::mutex> lock(m_view_condition_mutex);
 
+    // This thread owns the window's context until it exits.
+    m_view.acquire();
+
     for (;;) {
 
-        m_view_condition.wait_until(
-            lock,
-            stop,
-            high_resolution_clock::now() + m_view_delta,
-            [&]{ return false; }
-        );
+        // Sleep until there is something new to show.
+        m_view_condition.wait(lock, stop, [&]{ return m_redraw.load(); });
 
         // Check for exit signal
         if (stop.stop_requested())
             break;
 
-        m_view.render(m_model.space());
+        m_redraw = false;
+        lock.unlock();
+
+        steady_clock::time_point start = steady_clock::now();
+
+        m_view.process(m_edits);
+        render();
+
+        steady_clock::time_point presenting = steady_clock::now();
         m_view.display();
+        steady_clock::time_point shown = steady_clock::now();
+
+        m_frame_times.record(shown - start);
+
+        for (steady_clock::time_point edit : m_edits)
+            m_latencies.record(shown - edit);
+        m_edits.clear();
+
+        // Every frame moves the camera while panning.
+        if (m_view.moving())
+            m_redraw = true;
+
+        lock.lock();
+
+        // If display() returned without waiting for the vertical blank, vsync
+        // is unavailable, so wait out the rest of the frame instead.
+        if (shown - presenting < m_view_delta / 16) {
+            m_view_condition.wait_until(
+                lock,
+                stop,
+                start + m_view_delta,
+                [&]{ return false; }
+            );
+        }
+    }
+
+    m_view.release();
+}
+
+void Controller::package()
+{
+    Region region = m_view.viewport();
+    std::uint64_t generation = m_model.generation();
+
+    bool repackage = m_repackage.exchange(false);
+
+    if (generation == m_packaged_generation && region == m_packaged_region && !repackage)
+        return;
+
+    // If the view is behind then skip packaging, it only renders the newest.
+    Frame *frame = m_frames.write_slot();
+    if (!frame) {
+        m_repackage = m_repackage || repackage;
+        return;
     }
+
+    frame->generation = generation;
+    frame->region = region;
+    frame->tiles.clear();
+
+    // Only fetch the tiles that can be seen.
+    m_model.for_each_alive_in(region, [&](Tile tile) {
+        frame->tiles.push_back(tile);
+    });
+
+    m_frames.push();
+
+    m_packaged_generation = generation;
+    m_packaged_region = region;
+
+    redraw();
+}
+
+void Controller::render()
+{
+    Frame *frame = m_frames.latest_slot();
+    if (!frame)
+        return;
+
+    m_view.render(frame->region, frame->tiles);
+    m_frames.pop();
 }
 
 std::size_t Controller::performance()
@@ -162,13 +408,15 @@ void Controller::handle_key_press(sf::Event &event)
     switch(event.key.code)
     {
         case sf::Keyboard::Escape : exit(); break;
-        case sf::Keyboard::Space  : m_paused = !m_paused;    break;
+        case sf::Keyboard::Space  : handle_pause(); break;
+        case sf::Keyboard::C      : handle_clear(); break;
         case sf::Keyboard::W : m_up    = true; handle_movement(); break;
         case sf::Keyboard::A : m_left  = true; handle_movement(); break;
         case sf::Keyboard::S : m_down  = true; handle_movement(); break;
         case sf::Keyboard::D : m_right = true; handle_movement(); break;
         case sf::Keyboard::Up   : handle_speed(true); break;
         case sf::Keyboard::Down : handle_speed(false); break;
+        case sf::Keyboard::H    : dump(); break;
         default: break;
     }
 }
@@ -200,15 +448,25 @@ void Controller::handle_movement()
         m_view.pan_vertical(View::MoveAction::FORWARD);
     else
         m_view.pan_vertical(View::MoveAction::BACKWARD);
+
+    redraw();
 }
 
 void Controller::handle_resize(sf::Event &event)
 {
-    return;
+    m_view.resize(event.size.width, event.size.height);
+    redraw();
 }
 
 void Controller::handle_mouse_press(sf::Event &event)
 {
+    // A viewer's model only follows the server.
+    if (m_client)
+        return;
+
+    // Latency is measured from when the click is handled.
+    steady_clock::time_point time = steady_clock::now();
+
     // Get the tile clicked.
     sf::Vector2i tile = m_view.map_pixel_to_tile(
         event.mouseButton.x,
@@ -216,14 +474,26 @@ void Controller::handle_mouse_press(sf::Event &event)
     );
 
     // If a left click occured, set the tile, otherwise remove it.
-    if (event.mouseButton.button == sf::Mouse::Left) {
-        m_model.place(tile.x, tile.y);
-        m_view.render(tile.x, tile.y, true);
-    }
-    else {
-        m_model.remove(tile.x, tile.y);
-        m_view.render(tile.x, tile.y, false);
-    }
+    bool alive = event.mouseButton.button == sf::Mouse::Left;
+
+    std::uint64_t generation = alive
+        ? m_model.place(tile.x, tile.y)
+        : m_model.remove(tile.x, tile.y);
+
+    journal(JournalEntry {
+        generation,
+        alive ? JournalEntry::Type::PLACE : JournalEntry::Type::REMOVE,
+        tile.x,
+        tile.y
+    });
+
+    // Show the edit before the next generation. A frame packaged before the
+    // edit may still be rendered over it, or the view's queue may be full,
+    // so package a frame with the edit even if paused at the same generation.
+    m_view.edit(tile.x, tile.y, alive, time);
+    m_repackage = true;
+
+    redraw();
 }
 
 void Controller::handle_mouse_scroll(sf::Event &event)
@@ -234,18 +504,82 @@ void Controller::handle_mouse_scroll(sf::Event &event)
     else {
         m_view.zoom(View::ZoomAction::OUT);
     }
+
+    redraw();
+}
+
+void Controller::handle_pause()
+{
+    // The simulation thread journals the pause once its batch ends.
+    m_paused = !m_paused;
+    reschedule();
+}
+
+void Controller::handle_clear()
+{
+    // A viewer's model only follows the server.
+    if (m_client)
+        return;
+
+    journal(JournalEntry {m_model.clear(), JournalEntry::Type::CLEAR});
+
+    // Package the cleared region even if paused at the same generation.
+    m_repackage = true;
 }
 
 void Controller::handle_speed(bool increase)
 {
+    double target = m_target;
+
     if (increase)
-        m_model_delta = m_model_delta / 2;
+        target = target * 2;
+    else if (std::isinf(target))
+        target = m_target_maximum;
     else
-        m_model_delta =  m_model_delta * 2;
+        target = target / 2;
+
+    if (target < m_target_minimum)
+        target = m_target_minimum;
 
-    if (m_model_delta < m_model_delta_minimum)
-        m_model_delta = m_model_delta_minimum;
+    else if (target > m_target_maximum)
+        target = std::numeric_limits<double>::infinity();
+
+    // The simulation thread journals the speed once its batch ends.
+    m_target = target;
+    reschedule();
+}
 
-    else if (m_model_delta > m_model_delta_maximum)
-        m_model_delta = m_model_delta_maximum;
+void Controller::reschedule()
+{
+    // Take the mutex so the notification cannot fall between the simulation
+    // thread checking its predicate and waiting.
+    {
+        std::scoped_lock<std::mutex> lock(m_model_condition_mutex);
+    }
+
+    m_model_condition.notify_all();
+}
+
+void Controller::journal(const JournalEntry &entry)
+{
+    if (m_journal)
+        m_journal->record(entry);
+}
+
+void Controller::redraw()
+{
+    // Set the flag under the mutex so the notification cannot fall between
+    // the view thread checking its predicate and waiting.
+    {
+        std::scoped_lock<std::mutex> lock(m_view_condition_mutex);
+        m_redraw = true;
+    }
+
+    m_view_condition.notify_all();
+}
+
+void Controller::dump()
+{
+    m_frame_times.dump(std::cout);
+    m_latencies.dump(std::cout);
 }
@@ -7,9 +7,30 @@
 #include <SFML/System.hpp>
 #include <thread>
 
+#include "Client.hpp"
 #include "GameOfLife.hpp"
+#include "Histogram.hpp"
+#include "Journal.hpp"
+#include "RingBuffer.hpp"
+#include "Server.hpp"
 #include "View.hpp"
 
+/**
+ * @brief The alive tiles in the visible region of one generation, packaged by
+ * the simulation thread ready for the view thread to render.
+ */
+struct Frame {
+
+    /// The generation the tiles are from.
+    std::uint64_t generation;
+
+    /// The region of tiles that was visible when the frame was packaged.
+    Region region;
+
+    /// The alive tiles inside the region.
+    std::vector<Tile> tiles;
+};
+
 /**
  * @brief The controller class owns the thread incrementing the game of life
  * model, and the thread responsible for rendering the model. The controller
@@ -26,8 +47,27 @@ public:
      * 
      * Starts the model and view threads, sets the model to the initial state,
      * and displays the entire model space.
+     * 
+     * @param serve The port to serve the observer stream on, or zero to not
+     * serve.
+     * @param journal The path to journal every action changing the model to,
+     * or empty to not journal.
+     */
+    Controller(unsigned short serve = 0, const std::string &journal = "");
+
+    /**
+     * @brief Create the controller of a viewer, that only displays the model
+     * received by a client instead of running a simulation.
+     * 
+     * @param client A client connected to a server.
      */
-    Controller();
+    Controller(std::unique_ptr<Client> client);
+
+    /**
+     * @brief Stop the model and view threads, then end the journal with the
+     * final generation.
+     */
+    ~Controller();
 
     /**
      * @brief The user input loop fetching events and performing actions
@@ -37,6 +77,15 @@ public:
 
 private:
 
+    /**
+     * @brief Create the controller of a simulation or a viewer.
+     * 
+     * @param client A connected client if a viewer, otherwise nullptr.
+     * @param serve The port to serve the observer stream on, or zero.
+     * @param journal The path of the journal, or empty.
+     */
+    Controller(std::unique_ptr<Client> client, unsigned short serve, const std::string &journal);
+
     /**
      * @brief Joinable thread responsible for updating the simulation.
      * 
@@ -45,12 +94,35 @@ private:
     void simulation_thread(std::stop_token stop);
 
     /**
-     * @brief Joinable thread for updating the view of the simulation.
+     * @brief Joinable thread responsible for updating the model from the
+     * client, in place of the simulation thread when a viewer.
+     * 
+     * @param stop The stop signal issued to the thread to exit.
+     */
+    void client_thread(std::stop_token stop);
+
+    /**
+     * @brief Joinable thread for updating the view of the simulation, the
+     * only thread that renders. It only draws a frame when a new generation
+     * is packaged, the view is changed, or the camera is panning.
      * 
      * @param stop The stop signal issued to the thread to exit.
      */
     void view_thread(std::stop_token stop);
 
+    /**
+     * @brief Packages the visible region of the current generation into a free
+     * frame, if the generation or visible region changed since the last frame.
+     * Only called by the simulation thread, and never waits for the view.
+     */
+    void package();
+
+    /**
+     * @brief Renders the newest packaged frame, dropping any older frames.
+     * Only called by the view thread, and never waits for the simulation.
+     */
+    void render();
+
     /**
      * @brief Issues a stop request to the model and view threads.
      */
@@ -70,15 +142,51 @@ private:
     void handle_mouse_press(sf::Event &event);
     void handle_mouse_scroll(sf::Event &event);
 
+    // Pause or unpause the simulation.
+    void handle_pause();
+
+    // Set every tile dead.
+    void handle_clear();
+
     // Increase or decrease the speed of the simulation.
     void handle_speed(bool increase);
 
+    // Record an action in the journal, if journaling.
+    void journal(const JournalEntry &entry);
+
+    // Wake the simulation thread to reschedule after pausing or a speed change.
+    void reschedule();
+
+    // Wake the view thread to draw a frame after a change to show.
+    void redraw();
+
+    // Print the frame time and click to photon latency histograms.
+    void dump();
+
     /// View of the simulation.
     View m_view;
 
+    /// Client updating the model if a viewer.
+    std::unique_ptr<Client> m_client;
+
     // The game of life simulation that increments continuously.
     GameOfLife m_model;
 
+    /// Server of the observer stream, if serving.
+    std::unique_ptr<Server> m_server;
+
+    /// Journal of the actions changing the model, if journaling.
+    std::unique_ptr<Journal> m_journal;
+
+    /// Frames packaged by the simulation thread, consumed by the view thread.
+    RingBuffer<Frame, 4> m_frames;
+
+    /// The generation of the last packaged frame.
+    std::uint64_t m_packaged_generation;
+
+    /// The visible region of the last packaged frame.
+    Region m_packaged_region;
+
     /// Thread updating the model.
     std::jthread m_model_thread;
 
@@ -97,24 +205,51 @@ private:
     /// Mutex protecting the view condition variable.
     std::mutex m_view_condition_mutex;
 
-    /// The amount of time between model updates.
-    std::chrono::microseconds m_model_delta;
+    /// The target number of generations per second, infinite when unlimited.
+    std::atomic<double> m_target;
+
+    /// The slowest finite target generations per second.
+    double m_target_minimum;
 
-    /// Minimum increment between model increments.
-    std::chrono::microseconds m_model_delta_minimum;
+    /// The fastest finite target generations per second, increasing past
+    /// this is unlimited.
+    double m_target_maximum;
 
-    /// Maximum increment between model increments.
-    std::chrono::microseconds m_model_delta_maximum;
+    /// The longest the simulation thread spends on a batch of generations
+    /// before checking for pause and stop and packaging a frame.
+    std::chrono::microseconds m_batch_budget;
 
-    /// The amount of time between screen updates.
+    /// The amount of time between packaging frames when paused, so the view
+    /// still receives the panned and zoomed region.
+    std::chrono::microseconds m_paused_delta;
+
+    /// The shortest time between screen updates when vsync does not pace
+    /// them.
     std::chrono::microseconds m_view_delta;
 
+    /// The time from starting to draw a frame until it is displayed.
+    Histogram m_frame_times;
+
+    /// The time from a click until the frame showing its edit is displayed.
+    Histogram m_latencies;
+
+    /// The times of the edits applied to the frame being drawn, only used by
+    /// the view thread.
+    std::vector<std::chrono::steady_clock::time_point> m_edits;
+
     /// Stop signal to stop and join the model and view threads.
     std::stop_source m_stop;
 
     /// If the game is currently paused.
     std::atomic_bool m_paused;
 
+    /// If the next frame is packaged even if nothing changed, because an edit
+    /// could not be posted to the view.
+    std::atomic_bool m_repackage;
+
+    /// If the view thread has a change to draw.
+    std::atomic_bool m_redraw;
+
     /// The model iterations used to track performance.
     std::atomic_size_t m_iterations;
 
@@ -0,0 +1,507 @@
+#include "Daemon.hpp"
+
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+/// Set by the interrupt and terminate signals to stop the daemon.
+std::atomic_bool s_interrupted = false;
+
+/// The most tiles of a hosted game, so no client can exhaust the memory of
+/// the daemon and every game it hosts.
+constexpr std::int64_t s_max_tiles = std::int64_t(1) << 28;
+
+}
+
+Daemon::Daemon(const std::string &path, std::size_t threads)
+    : m_path(path)
+    , m_listener(-1)
+    , m_wake{-1, -1}
+    , m_instances()
+    , m_next_id(1)
+    , m_connections()
+    , m_pool(threads)
+{}
+
+Daemon::~Daemon()
+{
+    // Workers still processing commands write to the wake pipe and the
+    // connections, so they finish before any is closed.
+    m_pool.stop();
+
+#ifndef _WIN32
+    for (auto &[socket, connection] : m_connections)
+        close(socket);
+
+    if (m_listener >= 0) {
+        close(m_listener);
+        unlink(m_path.c_str());
+    }
+
+    if (m_wake[0] >= 0) {
+        close(m_wake[0]);
+        close(m_wake[1]);
+    }
+#endif
+}
+
+#ifdef _WIN32
+
+int Daemon::run()
+{
+    std::cerr << "The daemon requires Unix domain sockets.\n";
+    return 1;
+}
+
+void Daemon::wake() {}
+
+#else
+
+int Daemon::run()
+{
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+
+    if (m_path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Socket path " << m_path << " is too long.\n";
+        return 1;
+    }
+
+    m_path.copy(address.sun_path, m_path.size());
+    unlink(m_path.c_str());
+
+    m_listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_listener < 0
+        || bind(m_listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0
+        || listen(m_listener, SOMAXCONN) < 0
+        || pipe(m_wake) < 0) {
+        std::cerr << "Failed to listen on " << m_path << ".\n";
+        return 1;
+    }
+
+    fcntl(m_wake[0], F_SETFL, O_NONBLOCK);
+    fcntl(m_wake[1], F_SETFL, O_NONBLOCK);
+
+    std::signal(SIGINT, [](int) { s_interrupted = true; });
+    std::signal(SIGTERM, [](int) { s_interrupted = true; });
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::vector<pollfd> polls;
+    char buffer[65536];
+
+    while (!s_interrupted) {
+
+        polls.clear();
+        polls.push_back(pollfd(m_listener, POLLIN, 0));
+        polls.push_back(pollfd(m_wake[0], POLLIN, 0));
+
+        for (auto &[socket, connection] : m_connections) {
+            std::scoped_lock<std::mutex> lock(connection->mutex);
+            short events = POLLIN;
+
+            if (!connection->output.empty())
+                events |= POLLOUT;
+
+            polls.push_back(pollfd(socket, events, 0));
+        }
+
+        // Wake periodically to check for the interrupt signal.
+        if (poll(polls.data(), polls.size(), 100) <= 0)
+            continue;
+
+        if (polls[0].revents & POLLIN) {
+            int socket = accept(m_listener, nullptr, nullptr);
+
+            if (socket >= 0) {
+                fcntl(socket, F_SETFL, O_NONBLOCK);
+
+                auto connection = std::make_shared<Connection>();
+                connection->socket = socket;
+                m_connections.emplace(socket, connection);
+            }
+        }
+
+        // The wake up only makes the poll include waiting output.
+        if (polls[1].revents & POLLIN)
+            while (read(m_wake[0], buffer, sizeof(buffer)) > 0);
+
+        for (std::size_t i = 2; i < polls.size(); i++) {
+
+            std::shared_ptr<Connection> connection = m_connections[polls[i].fd];
+            bool closed = polls[i].revents & (POLLERR | POLLHUP | POLLNVAL);
+
+            if (polls[i].revents & POLLIN) {
+                ssize_t n = recv(connection->socket, buffer, sizeof(buffer), 0);
+
+                if (n > 0)
+                    connection->input.append(buffer, n);
+                else if (n == 0)
+                    closed = true;
+            }
+
+            // Queue every complete line, and start a worker if none is running
+            // the connection's commands.
+            std::size_t end = connection->input.rfind('\n');
+            bool start = false;
+
+            if (end != std::string::npos) {
+                std::istringstream lines(connection->input.substr(0, end));
+                connection->input.erase(0, end + 1);
+
+                std::scoped_lock<std::mutex> lock(connection->mutex);
+
+                for (std::string line; std::getline(lines, line);) {
+                    if (!line.empty() && line.back() == '\r')
+                        line.pop_back();
+                    if (!line.empty())
+                        connection->commands.push_back(line);
+                }
+
+                if (!connection->busy && !connection->commands.empty() && !connection->closing) {
+                    connection->busy = true;
+                    start = true;
+                }
+            }
+
+            if (start)
+                m_pool.submit([this, connection] { process(connection); });
+
+            std::scoped_lock<std::mutex> lock(connection->mutex);
+
+            if (polls[i].revents & POLLOUT && !connection->output.empty()) {
+                ssize_t n = send(
+                    connection->socket,
+                    connection->output.data(),
+                    connection->output.size(),
+                    MSG_NOSIGNAL
+                );
+
+                if (n > 0)
+                    connection->output.erase(0, n);
+                else if (n < 0 && errno != EAGAIN)
+                    closed = true;
+            }
+
+            if (connection->closing && !connection->busy && connection->output.empty())
+                closed = true;
+
+            // A worker may still hold the connection, but never its socket.
+            if (closed) {
+                close(connection->socket);
+                m_connections.erase(connection->socket);
+            }
+        }
+    }
+
+    return 0;
+}
+
+void Daemon::wake()
+{
+    char byte = 0;
+    [[maybe_unused]] ssize_t n = write(m_wake[1], &byte, 1);
+}
+
+#endif
+
+void Daemon::process(std::shared_ptr<Connection> connection)
+{
+    for (;;) {
+
+        std::string line;
+
+        {
+            std::scoped_lock<std::mutex> lock(connection->mutex);
+
+            if (connection->commands.empty() || connection->closing) {
+                connection->busy = false;
+                break;
+            }
+
+            line = std::move(connection->commands.front());
+            connection->commands.pop_front();
+        }
+
+        bool closing = false;
+        std::string response;
+
+        // A failing command only fails itself, not the daemon and its games.
+        try {
+            response = execute(line, closing) + "\n";
+        }
+        catch (const std::exception &error) {
+            response = "error " + std::string(error.what()) + "\n";
+        }
+
+        // Only wake the listening thread when output starts waiting, it sends
+        // everything that has accumulated by then.
+        bool waiting;
+
+        {
+            std::scoped_lock<std::mutex> lock(connection->mutex);
+
+            waiting = connection->output.empty();
+            connection->output += response;
+            connection->closing = connection->closing || closing;
+        }
+
+        if (waiting)
+            wake();
+    }
+
+    wake();
+}
+
+std::string Daemon::execute(const std::string &line, bool &closing)
+{
+    std::istringstream arguments(line);
+    std::string command;
+    arguments >> command;
+
+    // Commands that are not on a game.
+    if (command == "quit") {
+        closing = true;
+        return "ok";
+    }
+
+    if (command == "create") {
+        int width = 0;
+        int height = 0;
+
+        if (!(arguments >> width >> height) || width < 3 || height < 3)
+            return "error usage: create WIDTH HEIGHT";
+
+        if (std::int64_t(width) * height > s_max_tiles)
+            return "error more than " + std::to_string(s_max_tiles) + " tiles";
+
+        return "ok " + std::to_string(create(width, height));
+    }
+
+    if (command == "list") {
+        std::scoped_lock<std::mutex> lock(m_instances_mutex);
+        std::string response = "ok";
+
+        for (auto &[id, instance] : m_instances)
+            response += " " + std::to_string(id);
+
+        return response;
+    }
+
+    if (command == "restore") {
+        std::string path;
+        arguments >> path;
+
+        std::ifstream file(path);
+        std::string header;
+
+        if (!file || !std::getline(file, header))
+            return "error cannot read " + path;
+
+        // The header is "x = WIDTH, y = HEIGHT, rule = RULE".
+        int width = 0;
+        int height = 0;
+        char rule[32] = "B3/S23";
+
+        if (std::sscanf(header.c_str(), "x = %d, y = %d, rule = %31s", &width, &height, rule) < 2
+            || width < 3 || height < 3)
+            return "error invalid header in " + path;
+
+        if (std::int64_t(width) * height > s_max_tiles)
+            return "error more than " + std::to_string(s_max_tiles) + " tiles in " + path;
+
+        Rule parsed;
+        if (!parse_rule(rule, parsed))
+            return "error invalid rule in " + path;
+
+        std::stringstream body;
+        body << file.rdbuf();
+
+        std::uint32_t id = create(width, height);
+        std::shared_ptr<Instance> instance = find(id);
+        std::scoped_lock<std::mutex> lock(instance->mutex);
+
+        instance->model.rule(parsed);
+        if (!instance->model.load(0, 0, body.str())) {
+            std::scoped_lock<std::mutex> instances_lock(m_instances_mutex);
+            m_instances.erase(id);
+            return "error invalid pattern in " + path;
+        }
+
+        return "ok " + std::to_string(id);
+    }
+
+    // Commands on a game.
+    std::uint32_t id = 0;
+    if (!(arguments >> id))
+        return "error usage: " + (command.empty() ? "COMMAND" : command) + " ID ...";
+
+    if (command == "destroy") {
+        std::scoped_lock<std::mutex> lock(m_instances_mutex);
+        return m_instances.erase(id) ? "ok" : "error no game " + std::to_string(id);
+    }
+
+    std::shared_ptr<Instance> instance = find(id);
+    if (!instance)
+        return "error no game " + std::to_string(id);
+
+    std::scoped_lock<std::mutex> lock(instance->mutex);
+    GameOfLife &model = instance->model;
+
+    if (command == "rule") {
+        std::string text;
+        Rule rule;
+
+        if (!(arguments >> text) || !parse_rule(text, rule))
+            return "error usage: rule ID B3/S23";
+
+        model.rule(rule);
+        return "ok";
+    }
+
+    if (command == "load") {
+        int x = 0;
+        int y = 0;
+        std::string pattern;
+
+        if (!(arguments >> x >> y >> pattern) || !model.load(x, y, pattern))
+            return "error usage: load ID X Y PATTERN";
+
+        return "ok";
+    }
+
+    if (command == "soup") {
+        double density = 0;
+        unsigned seed = 0;
+
+        if (!(arguments >> density >> seed))
+            return "error usage: soup ID DENSITY SEED";
+
+        model.add_soup(density, seed);
+        return "ok";
+    }
+
+    if (command == "set") {
+        int x = 0;
+        int y = 0;
+        int state = 0;
+
+        if (!(arguments >> x >> y >> state))
+            return "error usage: set ID X Y STATE";
+
+        model.update(x, y, state);
+        return "ok";
+    }
+
+    if (command == "clear") {
+        model.clear();
+        return "ok";
+    }
+
+    if (command == "step") {
+        std::uint64_t n = 0;
+
+        if (!(arguments >> n))
+            return "error usage: step ID N";
+
+        for (std::uint64_t i = 0; i < n; i++)
+            model.advance();
+
+        return "ok " + std::to_string(model.generation());
+    }
+
+    if (command == "population") {
+        return "ok " + std::to_string(model.population());
+    }
+
+    if (command == "stats") {
+        Tile minimum = model.bounds_minimum();
+        Tile maximum = model.bounds_maximum();
+
+        std::ostringstream response;
+        response << "ok " << model.generation()
+                 << " " << model.population()
+                 << " " << model.births()
+                 << " " << model.deaths()
+                 << " " << minimum.x << " " << minimum.y
+                 << " " << maximum.x << " " << maximum.y;
+
+        return response.str();
+    }
+
+    if (command == "count" || command == "region") {
+        Region region;
+
+        if (!(arguments >> region.x >> region.y >> region.width >> region.height))
+            return "error usage: " + command + " ID X Y WIDTH HEIGHT";
+
+        if (command == "count")
+            return "ok " + std::to_string(model.count_in(region));
+
+        std::vector<Tile> tiles;
+        model.for_each_alive_in(region, [&](Tile tile) {
+            tiles.push_back(tile);
+        });
+
+        std::string response = "ok " + std::to_string(tiles.size());
+        for (Tile tile : tiles)
+            response += " " + std::to_string(tile.x) + " " + std::to_string(tile.y);
+
+        return response;
+    }
+
+    if (command == "checkpoint") {
+        std::string path;
+        if (!(arguments >> path))
+            return "error usage: checkpoint ID PATH";
+
+        std::ofstream file(path);
+        file << "x = " << model.width()
+             << ", y = " << model.height()
+             << ", rule = " << format_rule(model.rule()) << "\n";
+
+        // Lines of RLE are conventionally no longer than 70 characters.
+        std::string pattern = model.save();
+        for (std::size_t i = 0; i < pattern.size(); i += 70)
+            file << pattern.substr(i, 70) << "\n";
+
+        if (!file)
+            return "error cannot write " + path;
+
+        return "ok";
+    }
+
+    return "error unknown command " + command;
+}
+
+std::shared_ptr<Daemon::Instance> Daemon::find(std::uint32_t id)
+{
+    std::scoped_lock<std::mutex> lock(m_instances_mutex);
+
+    auto it = m_instances.find(id);
+    return it == m_instances.end() ? nullptr : it->second;
+}
+
+std::uint32_t Daemon::create(int width, int height)
+{
+    auto instance = std::make_shared<Instance>(width, height);
+
+    std::scoped_lock<std::mutex> lock(m_instances_mutex);
+    std::uint32_t id = m_next_id++;
+    m_instances.emplace(id, instance);
+
+    return id;
+}
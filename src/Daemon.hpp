@@ -0,0 +1,170 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "GameOfLife.hpp"
+#include "ThreadPool.hpp"
+
+/**
+ * @brief Hosts independent games of life, driven by clients over a Unix domain
+ * socket.
+ * 
+ * Clients send commands as lines of text and may send any number before
+ * reading the responses. The commands of each connection run in order on a
+ * shared worker pool, and each response is one line starting with "ok" or
+ * "error", streamed back as soon as its command completes. Connections run in
+ * parallel, and commands on the same game from different connections are
+ * serialised.
+ * 
+ * Commands, where ID is a game returned by create or restore:
+ * - create WIDTH HEIGHT          Responds with the ID of a new empty game, of
+ *                                at most 2^28 tiles.
+ * - destroy ID
+ * - list                         Responds with the ID of every game.
+ * - rule ID RULE                 Sets a rule in B/S notation, such as B36/S23.
+ * - load ID X Y PATTERN          Places an RLE pattern, such as bo$2bo$3o!.
+ * - soup ID DENSITY SEED         Places random tiles.
+ * - set ID X Y STATE             Sets a tile alive if STATE is 1, dead if 0.
+ * - clear ID
+ * - step ID N                    Responds with the generation after N steps.
+ * - population ID                Responds with the number of alive tiles.
+ * - stats ID                     Responds with the generation, population,
+ *                                births, deaths and bounding box.
+ * - count ID X Y WIDTH HEIGHT    Responds with the alive tiles in a region.
+ * - region ID X Y WIDTH HEIGHT   Responds with the count then the x and y of
+ *                                every alive tile in a region.
+ * - checkpoint ID PATH           Saves the game to an RLE file.
+ * - restore PATH                 Responds with the ID of a game loaded from an
+ *                                RLE file, of at most 2^28 tiles.
+ * - quit                         Closes the connection after its responses.
+ */
+class Daemon
+{
+public:
+
+    /**
+     * @brief Create a daemon listening on a Unix domain socket.
+     * 
+     * @param path The path of the socket, replaced if it exists.
+     * @param threads The number of worker threads, or zero for one per
+     * hardware thread.
+     */
+    Daemon(const std::string &path, std::size_t threads);
+
+    /**
+     * @brief Close all connections and remove the socket.
+     */
+    ~Daemon();
+
+    /**
+     * @brief Serve clients until interrupted.
+     * @return The exit code of the application.
+     */
+    int run();
+
+private:
+
+    /// A hosted game, whose mutex serialises commands from all connections.
+    struct Instance {
+
+        Instance(int width, int height)
+            : model(width, height)
+        {}
+
+        GameOfLife model;
+        std::mutex mutex;
+    };
+
+    /// A client connection.
+    struct Connection {
+
+        /// The connection's socket.
+        int socket;
+
+        /// Received bytes not yet forming a full line. Only used by the
+        /// listening thread.
+        std::string input;
+
+        /// Mutex protecting the following members, shared with the workers.
+        std::mutex mutex;
+
+        /// Commands received but not yet run.
+        std::deque<std::string> commands;
+
+        /// If a worker is running the connection's commands.
+        bool busy = false;
+
+        /// Responses not yet sent.
+        std::string output;
+
+        /// If the connection closes once its responses are sent.
+        bool closing = false;
+    };
+
+    /**
+     * @brief Run the commands of a connection in order until there are none
+     * left. Runs on a worker.
+     * 
+     * @param connection The connection.
+     */
+    void process(std::shared_ptr<Connection> connection);
+
+    /**
+     * @brief Run one command.
+     * 
+     * @param line The command.
+     * @param closing Set if the command closes the connection.
+     * @return The response, without a newline.
+     */
+    std::string execute(const std::string &line, bool &closing);
+
+    /**
+     * @brief Find a hosted game.
+     * @param id The ID of the game.
+     * @return The game, or nullptr if there is no game with the ID.
+     */
+    std::shared_ptr<Instance> find(std::uint32_t id);
+
+    /**
+     * @brief Host a new game.
+     * 
+     * @param width The width of the game space.
+     * @param height The height of the game space.
+     * @return The ID of the game.
+     */
+    std::uint32_t create(int width, int height);
+
+    /**
+     * @brief Wake the listening thread to send responses.
+     */
+    void wake();
+
+    /// The path of the socket.
+    std::string m_path;
+
+    /// The listening socket.
+    int m_listener;
+
+    /// Pipe written by workers to wake the listening thread.
+    int m_wake[2];
+
+    /// Mutex protecting the hosted games.
+    std::mutex m_instances_mutex;
+
+    /// The hosted games by ID.
+    std::unordered_map<std::uint32_t, std::shared_ptr<Instance>> m_instances;
+
+    /// The ID of the next game.
+    std::uint32_t m_next_id;
+
+    /// The connections by socket. Only used by the listening thread.
+    std::unordered_map<int, std::shared_ptr<Connection>> m_connections;
+
+    /// Workers running commands. Destroyed first, so running commands finish
+    /// before the games are destroyed.
+    ThreadPool m_pool;
+};
@@ -0,0 +1,441 @@
+#include "DistributedEngine.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+
+#ifndef _WIN32
+#include <csignal>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+
+namespace {
+
+/// The spins before a waiting process starts sleeping.
+constexpr int s_spins = 1024;
+
+/// Wait until a condition holds, spinning briefly before sleeping so idle
+/// processes do not hold a core.
+template<typename Condition>
+void await(Condition condition)
+{
+    using namespace std::chrono_literals;
+
+    for (int spins = 0; !condition(); spins++) {
+        if (spins < s_spins)
+            std::this_thread::yield();
+        else
+            std::this_thread::sleep_for(50us);
+    }
+}
+
+/// Round a size up to a multiple of the cache line size.
+constexpr std::size_t align(std::size_t size)
+{
+    return (size + 63) & ~std::size_t(63);
+}
+
+/// Find the boundaries splitting a length into n parts.
+std::vector<int> split(int length, int n)
+{
+    std::vector<int> boundaries;
+
+    for (int i = 0; i <= n; i++)
+        boundaries.push_back(int(std::int64_t(length) * i / n));
+
+    return boundaries;
+}
+
+}
+
+#ifdef _WIN32
+
+DistributedEngine::DistributedEngine(int width, int height, std::size_t)
+    : Engine(width, height)
+    , m_memory(nullptr)
+    , m_size(0)
+    , m_control(nullptr)
+    , m_blocks(nullptr)
+    , m_columns()
+    , m_rows()
+    , m_workers()
+    , m_generation(0)
+    , m_running(false)
+{}
+
+DistributedEngine::~DistributedEngine() {}
+void DistributedEngine::advance(std::vector<Tile> &, std::vector<Tile> &) {}
+void DistributedEngine::update(int, int, bool) {}
+void DistributedEngine::clear() {}
+void DistributedEngine::run(std::uint64_t) {}
+
+#else
+
+DistributedEngine::DistributedEngine(int width, int height, std::size_t workers)
+    : Engine(width, height)
+    , m_memory(nullptr)
+    , m_size(0)
+    , m_control(nullptr)
+    , m_blocks(nullptr)
+    , m_columns()
+    , m_rows()
+    , m_workers()
+    , m_generation(0)
+    , m_running(false)
+{
+    // Split into the grid of blocks with the shortest total edge length,
+    // because edges are what the workers exchange each generation. Reduce the
+    // workers until a grid fits the game space.
+    int n = int(std::max<std::size_t>(1, std::min<std::size_t>(workers, std::size_t(width) * height)));
+    int columns = 0;
+    int rows = 0;
+
+    for (; n > 0 && columns == 0; n--) {
+        for (int c = 1; c <= n; c++) {
+            int r = n / c;
+            if (c * r != n || c > width || r > height)
+                continue;
+
+            if (columns == 0 || std::int64_t(c) * height + std::int64_t(r) * width
+                              < std::int64_t(columns) * height + std::int64_t(rows) * width) {
+                columns = c;
+                rows = r;
+            }
+        }
+    }
+
+    n = columns * rows;
+    m_columns = split(width, columns);
+    m_rows = split(height, rows);
+
+    // Lay out the control block, the blocks, then each block's data.
+    m_size = align(sizeof(Control)) + align(sizeof(Block) * n);
+    std::vector<std::size_t> offsets;
+
+    for (int i = 0; i < n; i++) {
+        int w = m_columns[i % columns + 1] - m_columns[i % columns];
+        int h = m_rows[i / columns + 1] - m_rows[i / columns];
+
+        offsets.push_back(m_size);
+        m_size += 2 * align(std::size_t(w) * h)
+                + 2 * align(2 * std::size_t(w + h))
+                + align(3 * std::size_t(w + 2))
+                + align(sizeof(std::uint32_t) * w * h);
+    }
+
+    // The segment is unlinked as soon as it is mapped, so it disappears with
+    // the last process that maps it however the processes exit.
+    std::string path = "/gameoflife-" + std::to_string(getpid()) + "-"
+                     + std::to_string(reinterpret_cast<std::uintptr_t>(this));
+
+    int fd = shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0)
+        return;
+
+    shm_unlink(path.c_str());
+
+    void *memory = MAP_FAILED;
+    if (ftruncate(fd, off_t(m_size)) == 0)
+        memory = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    close(fd);
+
+    if (memory == MAP_FAILED)
+        return;
+
+    // Fresh shared memory is zeroed, so every tile starts dead.
+    m_memory = static_cast<std::uint8_t*>(memory);
+    m_control = new (m_memory) Control();
+    m_blocks = at<Block>(align(sizeof(Control)));
+
+    for (int i = 0; i < n; i++) {
+        int column = i % columns;
+        int row = i / columns;
+
+        Block *block = new (&m_blocks[i]) Block();
+        block->x = m_columns[column];
+        block->y = m_rows[row];
+        block->width = m_columns[column + 1] - block->x;
+        block->height = m_rows[row + 1] - block->y;
+
+        // Starting with north, the neighbors in compass directions wrapping
+        // around the edges of the game space.
+        auto index = [&](int dx, int dy) {
+            return (row + dy + rows) % rows * columns + (column + dx + columns) % columns;
+        };
+
+        int neighbors[8] = {
+            index(0, -1), index(1, -1), index(1, 0), index(1, 1),
+            index(0, 1), index(-1, 1), index(-1, 0), index(-1, -1)
+        };
+        std::memcpy(block->neighbors, neighbors, sizeof(neighbors));
+
+        std::size_t tiles = align(std::size_t(block->width) * block->height);
+        std::size_t edges = align(2 * std::size_t(block->width + block->height));
+
+        block->tiles[0] = offsets[i];
+        block->tiles[1] = block->tiles[0] + tiles;
+        block->edges[0] = block->tiles[1] + tiles;
+        block->edges[1] = block->edges[0] + edges;
+        block->rows = block->edges[1] + edges;
+        block->changes = block->rows + align(3 * std::size_t(block->width + 2));
+    }
+
+    for (int i = 0; i < n; i++) {
+        int pid = fork();
+
+        if (pid == 0)
+            work(i);
+
+        if (pid < 0)
+            return;
+
+        m_workers.push_back(pid);
+    }
+
+    m_running = true;
+}
+
+DistributedEngine::~DistributedEngine()
+{
+    if (m_control) {
+        m_control->stop.store(true, std::memory_order_release);
+    }
+
+    for (int pid : m_workers) {
+        waitpid(pid, nullptr, 0);
+    }
+
+    if (m_memory) {
+        munmap(m_memory, m_size);
+    }
+}
+
+void DistributedEngine::advance(std::vector<Tile> &born, std::vector<Tile> &died)
+{
+    if (!m_running)
+        return;
+
+    m_control->record.store(true, std::memory_order_relaxed);
+    run(1);
+
+    // Changed tiles alive in the new generation were born, otherwise they died.
+    int parity = m_generation % 2;
+
+    for (std::size_t i = 0; i < m_workers.size(); i++) {
+        Block &block = m_blocks[i];
+        const std::uint8_t *tiles = at<std::uint8_t>(block.tiles[parity]);
+        const std::uint32_t *changes = at<std::uint32_t>(block.changes);
+        std::uint32_t changed = block.changed.load(std::memory_order_acquire);
+
+        for (std::uint32_t j = 0; j < changed; j++) {
+            Tile tile(block.x + changes[j] % block.width, block.y + changes[j] / block.width);
+            (tiles[changes[j]] ? born : died).push_back(tile);
+        }
+    }
+
+    m_control->record.store(false, std::memory_order_relaxed);
+}
+
+void DistributedEngine::update(int x, int y, bool alive)
+{
+    if (!m_running || x < 0 || x >= m_width || y < 0 || y >= m_height)
+        return;
+
+    // The workers are idle between generations, so the current generation of
+    // the block is only touched here until the next release.
+    Block &block = m_blocks[owner(x, y)];
+    std::uint8_t *tiles = at<std::uint8_t>(block.tiles[m_generation % 2]);
+    tiles[(y - block.y) * block.width + (x - block.x)] = alive;
+}
+
+void DistributedEngine::clear()
+{
+    if (!m_running)
+        return;
+
+    for (std::size_t i = 0; i < m_workers.size(); i++) {
+        Block &block = m_blocks[i];
+        std::memset(at<std::uint8_t>(block.tiles[m_generation % 2]), 0, std::size_t(block.width) * block.height);
+    }
+}
+
+void DistributedEngine::run(std::uint64_t generations)
+{
+    if (!m_running || generations == 0)
+        return;
+
+    m_control->birth.store(m_rule.birth, std::memory_order_relaxed);
+    m_control->survival.store(m_rule.survival, std::memory_order_relaxed);
+
+    // Releasing the target publishes the edits and the rule to the workers.
+    m_generation += generations;
+    m_control->target.store(m_generation, std::memory_order_release);
+    wait();
+}
+
+void DistributedEngine::wait()
+{
+    for (std::size_t i = 0; i < m_workers.size(); i++) {
+        await([&]{ return m_blocks[i].generation.load(std::memory_order_acquire) >= m_generation; });
+    }
+}
+
+int DistributedEngine::owner(int x, int y) const
+{
+    int column = int(std::upper_bound(m_columns.begin(), m_columns.end(), x) - m_columns.begin()) - 1;
+    int row = int(std::upper_bound(m_rows.begin(), m_rows.end(), y) - m_rows.begin()) - 1;
+    return row * (int(m_columns.size()) - 1) + column;
+}
+
+void DistributedEngine::work(int index)
+{
+    // Workers are forked from a process that may have other threads, so they
+    // only touch shared memory, never allocate, and never return or unwind
+    // into the coordinator's stack.
+#ifdef __linux__
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+#endif
+
+    Block &block = m_blocks[index];
+    std::uint64_t generation = m_generation;
+
+    while (true) {
+
+        await([&]{
+            return m_control->target.load(std::memory_order_acquire) > generation
+                || m_control->stop.load(std::memory_order_acquire)
+                || getppid() == 1;
+        });
+
+        if (m_control->stop.load(std::memory_order_acquire) || getppid() == 1)
+            _exit(0);
+
+        // Publish the edges of this generation.
+        int w = block.width;
+        int h = block.height;
+        const std::uint8_t *tiles = at<std::uint8_t>(block.tiles[generation % 2]);
+        std::uint8_t *edges = at<std::uint8_t>(block.edges[generation % 2]);
+
+        std::memcpy(edges, tiles, w);
+        std::memcpy(edges + w, tiles + std::size_t(h - 1) * w, w);
+
+        for (int y = 0; y < h; y++) {
+            edges[2 * w + y] = tiles[y * w];
+            edges[2 * w + h + y] = tiles[y * w + w - 1];
+        }
+
+        block.published.store(generation + 1, std::memory_order_release);
+
+        // Only the neighbors need to have caught up, not every worker.
+        for (int neighbor : block.neighbors) {
+            const Block &other = m_blocks[neighbor];
+            await([&]{ return other.published.load(std::memory_order_acquire) > generation; });
+        }
+
+        step(index, generation);
+
+        generation++;
+        block.generation.store(generation, std::memory_order_release);
+    }
+}
+
+void DistributedEngine::step(int index, std::uint64_t generation)
+{
+    Block &block = m_blocks[index];
+    int parity = generation % 2;
+    int w = block.width;
+    int h = block.height;
+
+    const std::uint8_t *current = at<std::uint8_t>(block.tiles[parity]);
+    std::uint8_t *next = at<std::uint8_t>(block.tiles[!parity]);
+    std::uint8_t *rows = at<std::uint8_t>(block.rows);
+    std::uint32_t *changes = at<std::uint32_t>(block.changes);
+    bool record = m_control->record.load(std::memory_order_relaxed);
+    std::uint32_t changed = 0;
+
+    // The edges of the neighbors, in compass directions starting with north.
+    const std::uint8_t *edges[8];
+    for (int i = 0; i < 8; i++)
+        edges[i] = at<std::uint8_t>(m_blocks[block.neighbors[i]].edges[parity]);
+
+    // The top and bottom rows, and left and right columns, in the edges of a
+    // neighbor. Neighbors in the same row share the height.
+    auto width = [&](int i) { return m_blocks[block.neighbors[i]].width; };
+    auto top = [&](int i) { return edges[i]; };
+    auto bottom = [&](int i) { return edges[i] + width(i); };
+    auto left = [&](int i) { return edges[i] + 2 * width(i); };
+    auto right = [&](int i) { return edges[i] + 2 * width(i) + h; };
+
+    // Fill an extended row from -1 to h with the tiles left and right of it.
+    auto fill = [&](int y) {
+        std::uint8_t *row = rows + std::size_t((y + 3) % 3) * (w + 2);
+
+        if (y < 0) {
+            row[0] = bottom(7)[width(7) - 1];
+            std::memcpy(row + 1, bottom(0), w);
+            row[w + 1] = bottom(1)[0];
+        }
+        else if (y >= h) {
+            row[0] = top(5)[width(5) - 1];
+            std::memcpy(row + 1, top(4), w);
+            row[w + 1] = top(3)[0];
+        }
+        else {
+            row[0] = right(6)[y];
+            std::memcpy(row + 1, current + std::size_t(y) * w, w);
+            row[w + 1] = left(2)[y];
+        }
+    };
+
+    // The next state of a tile by its state and its number of alive neighbors.
+    std::uint8_t rule[2][9];
+    std::uint16_t birth = m_control->birth.load(std::memory_order_relaxed);
+    std::uint16_t survival = m_control->survival.load(std::memory_order_relaxed);
+
+    for (int n = 0; n <= 8; n++) {
+        rule[0][n] = birth >> n & 1;
+        rule[1][n] = survival >> n & 1;
+    }
+
+    fill(-1);
+    fill(0);
+
+    for (int y = 0; y < h; y++) {
+        fill(y + 1);
+
+        const std::uint8_t *above = rows + std::size_t((y + 2) % 3) * (w + 2);
+        const std::uint8_t *middle = rows + std::size_t(y % 3) * (w + 2);
+        const std::uint8_t *below = rows + std::size_t((y + 1) % 3) * (w + 2);
+        std::uint8_t *out = next + std::size_t(y) * w;
+
+        for (int x = 0; x < w; x++) {
+            int n = above[x] + above[x + 1] + above[x + 2]
+                  + middle[x] + middle[x + 2]
+                  + below[x] + below[x + 1] + below[x + 2];
+
+            out[x] = rule[middle[x + 1]][n];
+        }
+
+        if (record) {
+            const std::uint8_t *in = current + std::size_t(y) * w;
+            for (int x = 0; x < w; x++)
+                if (out[x] != in[x])
+                    changes[changed++] = std::uint32_t(y * w + x);
+        }
+    }
+
+    block.changed.store(changed, std::memory_order_release);
+}
+
+#endif
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "Engine.hpp"
+
+/**
+ * @brief An engine partitioning the game space into rectangular blocks, each
+ * stepped by its own worker process.
+ * 
+ * Every block, and the one tile wide rows and columns on its edges, live in a
+ * POSIX shared memory segment mapped by the coordinator and all workers. Each
+ * generation a worker publishes its edges and bumps its sequence counter, then
+ * waits only for the counters of its eight neighbors before stepping. Edges
+ * are double buffered by generation parity, so no worker can overwrite an edge
+ * a neighbor still needs, and no locks are taken.
+ * 
+ * The coordinator is the engine itself. It releases the workers one or more
+ * generations at a time and assembles the changes and blocks they leave in
+ * shared memory, while the workers are idle.
+ */
+class DistributedEngine : public Engine
+{
+public:
+
+    /**
+     * @brief Create the shared memory and fork the workers.
+     * 
+     * @param width The width of the grid in tiles.
+     * @param height The height of the grid in tiles.
+     * @param workers The number of worker processes, reduced to fit the game
+     * space.
+     */
+    DistributedEngine(int width, int height, std::size_t workers);
+
+    /**
+     * @brief Stop and reap the workers, and unmap the shared memory.
+     */
+    ~DistributedEngine();
+
+    void advance(std::vector<Tile> &born, std::vector<Tile> &died) override;
+    void update(int x, int y, bool alive) override;
+    void clear() override;
+
+    std::string name() const override {
+        return "distributed";
+    }
+
+    std::size_t memory() const override {
+        return m_size;
+    }
+
+    /**
+     * @brief Advance many generations without recording changes, with workers
+     * only synchronising with their neighbors between generations.
+     * 
+     * @param generations The number of generations.
+     */
+    void run(std::uint64_t generations);
+
+    /**
+     * @brief Get the number of worker processes.
+     * @return The number of worker processes.
+     */
+    inline std::size_t workers() const {
+        return m_workers.size();
+    }
+
+    /**
+     * @brief If the workers are running.
+     * @return If the workers were started.
+     */
+    inline bool running() const {
+        return m_running;
+    }
+
+private:
+
+    /// State shared by the coordinator and all workers.
+    struct Control {
+
+        /// The generation workers advance up to.
+        std::atomic_uint64_t target;
+
+        /// If workers exit.
+        std::atomic_bool stop;
+
+        /// If workers record the changes of each generation.
+        std::atomic_bool record;
+
+        /// The rule of the next generations.
+        std::atomic_uint16_t birth;
+        std::atomic_uint16_t survival;
+    };
+
+    /// The block of a worker, and the offsets of its data in shared memory.
+    struct Block {
+
+        /// The worker's block of tiles in the game space.
+        int x;
+        int y;
+        int width;
+        int height;
+
+        /// The indices of the workers around the block, starting north and
+        /// going clockwise.
+        int neighbors[8];
+
+        /// The block's tiles by generation parity, row major.
+        std::size_t tiles[2];
+
+        /// The block's edges by generation parity. The top row, bottom row,
+        /// left column then right column.
+        std::size_t edges[2];
+
+        /// Three rows extended by the edges of the neighbors.
+        std::size_t rows;
+
+        /// The changes of the last generation.
+        std::size_t changes;
+
+        /// The number of changes of the last generation.
+        alignas(64) std::atomic_uint32_t changed;
+
+        /// One more than the generation whose edges are published.
+        alignas(64) std::atomic_uint64_t published;
+
+        /// The generation the block has advanced to.
+        alignas(64) std::atomic_uint64_t generation;
+    };
+
+    /**
+     * @brief The loop of a worker process, which never returns.
+     * @param index The index of the worker.
+     */
+    [[noreturn]] void work(int index);
+
+    /**
+     * @brief Advance a worker's block by one generation.
+     * 
+     * @param index The index of the worker.
+     * @param generation The generation of the block.
+     */
+    void step(int index, std::uint64_t generation);
+
+    /**
+     * @brief Wait for the workers to advance to the target generation.
+     */
+    void wait();
+
+    /**
+     * @brief Get a pointer into the shared memory.
+     * 
+     * @tparam T The type pointed to.
+     * @param offset The offset of the pointer.
+     * @return The pointer.
+     */
+    template<typename T>
+    inline T *at(std::size_t offset) {
+        return reinterpret_cast<T *>(m_memory + offset);
+    }
+
+    /**
+     * @brief Find the worker whose block contains a tile.
+     * 
+     * @param x The x position in the grid.
+     * @param y The y position in the grid.
+     * @return The index of the worker.
+     */
+    int owner(int x, int y) const;
+
+    /// The shared memory.
+    std::uint8_t *m_memory;
+
+    /// The size of the shared memory in bytes.
+    std::size_t m_size;
+
+    /// The shared control state.
+    Control *m_control;
+
+    /// The block of each worker, in shared memory.
+    Block *m_blocks;
+
+    /// The left edge of each column of blocks, and the width.
+    std::vector<int> m_columns;
+
+    /// The top edge of each row of blocks, and the height.
+    std::vector<int> m_rows;
+
+    /// The process ID of each worker.
+    std::vector<int> m_workers;
+
+    /// The generation the workers have advanced to.
+    std::uint64_t m_generation;
+
+    /// If the workers were started.
+    bool m_running;
+};
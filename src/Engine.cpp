@@ -0,0 +1,275 @@
+#include "Engine.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+#include "BlockedEngine.hpp"
+#include "CompressedEngine.hpp"
+#include "DistributedEngine.hpp"
+#include "FixedEngine.hpp"
+#include "HybridEngine.hpp"
+#include "LargerThanLifeEngine.hpp"
+#include "LutEngine.hpp"
+#include "SparseEngine.hpp"
+
+namespace {
+
+/// A game space size with a compile time specialised engine.
+struct FixedSize {
+    int width;
+    int height;
+    std::unique_ptr<Engine> (*create)();
+};
+
+template<int W, int H>
+std::unique_ptr<Engine> create_fixed()
+{
+    return std::make_unique<FixedEngine<W, H>>();
+}
+
+/// Production game space sizes. The power of two sizes wrap with a mask, and
+/// the others are the sizes the controller creates for common 16:9 displays.
+const FixedSize s_fixed_sizes[] = {
+    {64, 64, create_fixed<64, 64>},
+    {256, 256, create_fixed<256, 256>},
+    {1024, 1024, create_fixed<1024, 1024>},
+    {4096, 4096, create_fixed<4096, 4096>},
+    {64, 36, create_fixed<64, 36>},
+    {96, 54, create_fixed<96, 54>},
+    {128, 72, create_fixed<128, 72>},
+    {192, 108, create_fixed<192, 108>},
+};
+
+}
+
+bool parse_rule(const std::string &text, Rule &rule)
+{
+    Rule parsed = {0, 0};
+    std::uint16_t *mask = nullptr;
+
+    for (char c : text) {
+        if (c == 'B' || c == 'b')
+            mask = &parsed.birth;
+        else if (c == 'S' || c == 's')
+            mask = &parsed.survival;
+        else if (c >= '0' && c <= '8' && mask)
+            *mask |= 1 << (c - '0');
+        else if (c != '/')
+            return false;
+    }
+
+    if (parsed.birth & 1) {
+        return false;
+    }
+
+    rule = parsed;
+    return true;
+}
+
+std::string format_rule(Rule rule)
+{
+    std::string text = "B";
+
+    for (int n = 0; n <= 8; n++)
+        if (rule.birth >> n & 1)
+            text += char('0' + n);
+
+    text += "/S";
+
+    for (int n = 0; n <= 8; n++)
+        if (rule.survival >> n & 1)
+            text += char('0' + n);
+
+    return text;
+}
+
+bool parse_ltl_rule(const std::string &text, LtlRule &rule)
+{
+    LtlRule parsed = {0, false, false, -1, -1, -1, -1};
+
+    // Parse an interval, such as 34..58.
+    auto interval = [](const std::string &value, int &minimum, int &maximum) {
+        std::size_t dots = value.find("..");
+        if (dots == std::string::npos)
+            return false;
+
+        minimum = std::stoi(value.substr(0, dots));
+        maximum = std::stoi(value.substr(dots + 2));
+        return minimum >= 0 && minimum <= maximum;
+    };
+
+    try {
+        std::size_t start = 0;
+        while (start <= text.size()) {
+
+            std::size_t end = text.find(',', start);
+            if (end == std::string::npos)
+                end = text.size();
+
+            std::string field = text.substr(start, end - start);
+            start = end + 1;
+
+            if (field.empty())
+                return false;
+
+            char key = std::toupper(field[0]);
+            std::string value = field.substr(1);
+
+            if (key == 'R') {
+                parsed.radius = std::stoi(value);
+            }
+            else if (key == 'C') {
+                int states = std::stoi(value);
+                if (states != 0 && states != 2)
+                    return false;
+            }
+            else if (key == 'M') {
+                if (value != "0" && value != "1")
+                    return false;
+                parsed.middle = value == "1";
+            }
+            else if (key == 'S') {
+                if (!interval(value, parsed.survival_minimum, parsed.survival_maximum))
+                    return false;
+            }
+            else if (key == 'B') {
+                if (!interval(value, parsed.birth_minimum, parsed.birth_maximum))
+                    return false;
+            }
+            else if (key == 'N') {
+                if (value != "M" && value != "N" && value != "m" && value != "n")
+                    return false;
+                parsed.von_neumann = value == "N" || value == "n";
+            }
+            else {
+                return false;
+            }
+        }
+    }
+    catch (const std::logic_error &) {
+        // Numbers that do not parse, from std::stoi.
+        return false;
+    }
+
+    if (parsed.radius < 1 || parsed.birth_minimum < 0 || parsed.survival_minimum < 0)
+        return false;
+
+    rule = parsed;
+    return true;
+}
+
+std::string format_ltl_rule(const LtlRule &rule)
+{
+    return "R" + std::to_string(rule.radius)
+        + ",C0,M" + (rule.middle ? "1" : "0")
+        + ",S" + std::to_string(rule.survival_minimum) + ".." + std::to_string(rule.survival_maximum)
+        + ",B" + std::to_string(rule.birth_minimum) + ".." + std::to_string(rule.birth_maximum)
+        + ",N" + (rule.von_neumann ? "N" : "M");
+}
+
+void Engine::advance_batch(std::uint64_t generations, std::vector<Tile> &born, std::vector<Tile> &died)
+{
+    // If each changed tile's state differs from before, and its state now.
+    std::unordered_map<Tile, std::pair<bool, bool>> changed;
+    std::vector<Tile> step_born;
+    std::vector<Tile> step_died;
+
+    for (std::uint64_t i = 0; i < generations; i++) {
+        step_born.clear();
+        step_died.clear();
+        advance(step_born, step_died);
+
+        for (Tile tile : step_born) {
+            auto &[differs, alive] = changed[tile];
+            differs = !differs;
+            alive = true;
+        }
+
+        for (Tile tile : step_died) {
+            auto &[differs, alive] = changed[tile];
+            differs = !differs;
+            alive = false;
+        }
+    }
+
+    for (const auto &[tile, state] : changed) {
+        if (state.first)
+            (state.second ? born : died).push_back(tile);
+    }
+}
+
+std::unique_ptr<Engine> make_engine(int width, int height)
+{
+    for (const FixedSize &size : s_fixed_sizes) {
+        if (size.width == width && size.height == height) {
+            return size.create();
+        }
+    }
+
+    return std::make_unique<SparseEngine>(width, height);
+}
+
+std::unique_ptr<Engine> make_engine(const std::string &name, int width, int height, std::size_t workers)
+{
+    if (name == "sparse") {
+        return std::make_unique<SparseEngine>(width, height);
+    }
+
+    if (name == "fixed") {
+        for (const FixedSize &size : s_fixed_sizes) {
+            if (size.width == width && size.height == height) {
+                return size.create();
+            }
+        }
+    }
+
+    if (name == "compressed") {
+        return std::make_unique<CompressedEngine>(width, height);
+    }
+
+    if (name == "hybrid") {
+        return std::make_unique<HybridEngine>(width, height);
+    }
+
+    if (name == "lut" && width % 2 == 0 && height % 2 == 0) {
+        return std::make_unique<LutEngine>(width, height);
+    }
+
+    if (name == "ltl") {
+        return make_engine(s_bosco, width, height, workers);
+    }
+
+    if (name == "blocked" && width % 64 == 0) {
+        if (workers == 0)
+            workers = std::max(1u, std::thread::hardware_concurrency());
+
+        return std::make_unique<BlockedEngine>(width, height, BlockedEngine::s_default_depth, workers);
+    }
+
+    if (name == "distributed") {
+        if (workers == 0)
+            workers = std::max(1u, std::thread::hardware_concurrency());
+
+        auto engine = std::make_unique<DistributedEngine>(width, height, workers);
+        if (engine->running()) {
+            return engine;
+        }
+    }
+
+    return nullptr;
+}
+
+std::unique_ptr<Engine> make_engine(const LtlRule &rule, int width, int height, std::size_t workers)
+{
+    if (2 * rule.radius + 1 > std::min(width, height)) {
+        return nullptr;
+    }
+
+    if (workers == 0)
+        workers = std::max(1u, std::thread::hardware_concurrency());
+
+    return std::make_unique<LargerThanLifeEngine>(width, height, rule, workers);
+}
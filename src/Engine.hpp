@@ -0,0 +1,268 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Tile.hpp"
+
+/**
+ * @brief A life-like rule, where bit n of each mask is set if a tile with n
+ * alive neighbors is born or survives.
+ */
+struct Rule {
+    std::uint16_t birth;
+    std::uint16_t survival;
+};
+
+inline bool operator==(const Rule &left, const Rule &right) {
+    return left.birth == right.birth && left.survival == right.survival;
+}
+
+/// Conway's rule, B3/S23.
+constexpr Rule s_conway = {1 << 3, (1 << 2) | (1 << 3)};
+
+/**
+ * @brief Parse a rule in B/S notation, such as "B36/S23" for HighLife. Rules
+ * with B0 are rejected because births far from any alive tile would fill the
+ * sparse engines' game space.
+ * 
+ * @param text The rule.
+ * @param rule Assigned the parsed rule.
+ * @return If the rule is valid.
+ */
+bool parse_rule(const std::string &text, Rule &rule);
+
+/**
+ * @brief Format a rule in B/S notation.
+ * 
+ * @param rule The rule.
+ * @return The rule in B/S notation.
+ */
+std::string format_rule(Rule rule);
+
+/**
+ * @brief A Larger than Life rule, counting the alive tiles within a radius
+ * and keeping or making a tile alive if the count is inside an interval.
+ */
+struct LtlRule {
+
+    /// The range of the neighborhood.
+    int radius;
+
+    /// If the tile itself is counted.
+    bool middle;
+
+    /// If the neighborhood is the von Neumann diamond, otherwise the Moore
+    /// square.
+    bool von_neumann;
+
+    /// The counts a dead tile is born with, inclusive.
+    int birth_minimum;
+    int birth_maximum;
+
+    /// The counts an alive tile survives with, inclusive.
+    int survival_minimum;
+    int survival_maximum;
+};
+
+inline bool operator==(const LtlRule &left, const LtlRule &right) {
+    return left.radius == right.radius && left.middle == right.middle
+        && left.von_neumann == right.von_neumann
+        && left.birth_minimum == right.birth_minimum && left.birth_maximum == right.birth_maximum
+        && left.survival_minimum == right.survival_minimum && left.survival_maximum == right.survival_maximum;
+}
+
+/// Bosco's rule, R5,C0,M1,S34..58,B34..45,NM.
+constexpr LtlRule s_bosco = {5, true, false, 34, 45, 34, 58};
+
+/**
+ * @brief Parse a Larger than Life rule in the notation of Golly, such as
+ * "R5,C0,M1,S34..58,B34..45,NM" for Bosco's rule. Only rules of two states,
+ * C0 or C2, are accepted. The middle defaults to M0 and the neighborhood to
+ * NM, the Moore square, while NN is the von Neumann diamond.
+ * 
+ * @param text The rule.
+ * @param rule Assigned the parsed rule.
+ * @return If the rule is valid.
+ */
+bool parse_ltl_rule(const std::string &text, LtlRule &rule);
+
+/**
+ * @brief Format a Larger than Life rule in the notation of Golly.
+ * 
+ * @param rule The rule.
+ * @return The rule in the notation of Golly.
+ */
+std::string format_ltl_rule(const LtlRule &rule);
+
+/**
+ * @brief Interface of an algorithm stepping the game of life.
+ * 
+ * An engine owns its own representation of the game space and reports the
+ * tiles that changed on each step, so that GameOfLife can keep its statistics
+ * and spatial index without knowing how the engine stores tiles. Engines are
+ * not thread safe, GameOfLife serialises all calls.
+ */
+class Engine
+{
+public:
+
+    /**
+     * @brief Create an engine with an empty game space.
+     * 
+     * @param width The width of the grid in tiles.
+     * @param height The height of the grid in tiles.
+     */
+    Engine(int width, int height)
+        : m_width(width)
+        , m_height(height)
+        , m_rule(s_conway)
+    {}
+
+    virtual ~Engine() = default;
+
+    /**
+     * @brief Advances the game space by one generation.
+     * 
+     * @param born Appended with each tile that became alive.
+     * @param died Appended with each tile that died.
+     */
+    virtual void advance(std::vector<Tile> &born, std::vector<Tile> &died) = 0;
+
+    /**
+     * @brief Advances the game space by many generations, reporting only the
+     * tiles whose state differs from before them.
+     * 
+     * The default advances one generation at a time, following each tile's
+     * changes. Engines advancing several generations per pass override it.
+     * 
+     * @param generations The number of generations.
+     * @param born Appended with each tile alive after but not before.
+     * @param died Appended with each tile alive before but not after.
+     */
+    virtual void advance_batch(std::uint64_t generations, std::vector<Tile> &born, std::vector<Tile> &died);
+
+    /**
+     * @brief Get the generations each pass over the game space advances, which
+     * advance_batch() takes advantage of when above one.
+     * @return The depth.
+     */
+    virtual int depth() const {
+        return 1;
+    }
+
+    /**
+     * @brief Sets a tile inside the game space to alive or dead.
+     * 
+     * @param x The x position in the grid.
+     * @param y The y position in the grid.
+     * @param alive If the tile is alive.
+     */
+    virtual void update(int x, int y, bool alive) = 0;
+
+    /**
+     * @brief Sets all tiles to dead.
+     */
+    virtual void clear() = 0;
+
+    /**
+     * @brief Get the name the engine is selected by.
+     * @return The name of the engine.
+     */
+    virtual std::string name() const = 0;
+
+    /**
+     * @brief Get the memory the engine's game space occupies.
+     * @return The approximate size of the game space in bytes.
+     */
+    virtual std::size_t memory() const = 0;
+
+    /**
+     * @brief Set the rule of each following advance().
+     * @param rule The rule.
+     */
+    inline void rule(Rule rule) {
+        m_rule = rule;
+    }
+
+    /**
+     * @brief Get the rule the engine advances by.
+     * @return The rule.
+     */
+    inline Rule rule() const {
+        return m_rule;
+    }
+
+    /**
+     * @brief Get the width of the simulation space.
+     * @return The width of the simulation space.
+     */
+    inline int width() const {
+        return m_width;
+    }
+
+    /**
+     * @brief Get the height of the simulation space.
+     * @return The height of the simulation space.
+     */
+    inline int height() const {
+        return m_height;
+    }
+
+protected:
+
+    /// The width of the game space.
+    int m_width;
+
+    /// The height of the game space.
+    int m_height;
+
+    /// The rule the game space advances by.
+    Rule m_rule;
+};
+
+/**
+ * @brief Create the fastest engine available for a game space size.
+ * 
+ * Sizes with a compile time specialised engine get one, any other size gets
+ * the runtime sized sparse engine.
+ * 
+ * @param width The width of the grid in tiles.
+ * @param height The height of the grid in tiles.
+ * @return The engine.
+ */
+std::unique_ptr<Engine> make_engine(int width, int height);
+
+/**
+ * @brief Create an engine by name for a game space size.
+ * 
+ * The names are "sparse", "fixed", "hybrid", "compressed", "lut",
+ * "distributed", "ltl" and "blocked". Fixed engines only exist for the compile
+ * time specialised sizes, lookup table engines for even sizes and blocked
+ * engines for widths that are a multiple of 64. The ltl engine runs Bosco's
+ * rule, see make_engine(LtlRule, ...) for other rules.
+ * 
+ * @param name The name of the engine.
+ * @param width The width of the grid in tiles.
+ * @param height The height of the grid in tiles.
+ * @param workers The number of workers of engines that have them, or zero for
+ * one per hardware thread.
+ * @return The engine, or null if the name is unknown or the engine is not
+ * available for the size.
+ */
+std::unique_ptr<Engine> make_engine(const std::string &name, int width, int height, std::size_t workers);
+
+/**
+ * @brief Create an engine stepping a Larger than Life rule.
+ * 
+ * @param rule The rule.
+ * @param width The width of the grid in tiles.
+ * @param height The height of the grid in tiles.
+ * @param workers The number of worker threads, or zero for one per hardware
+ * thread.
+ * @return The engine, or null if the neighborhood does not fit in the game
+ * space without wrapping onto itself.
+ */
+std::unique_ptr<Engine> make_engine(const LtlRule &rule, int width, int height, std::size_t workers);
@@ -0,0 +1,165 @@
+#include "Exporter.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <SFML/Graphics.hpp>
+
+namespace {
+
+/// The frames of the pool for each encoder thread, so threads never wait for
+/// the model to capture a frame.
+constexpr std::size_t s_frames_per_thread = 2;
+
+/// If a string ends with a suffix.
+bool ends_with(const std::string &text, const std::string &suffix)
+{
+    return text.size() >= suffix.size()
+        && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+}
+
+Exporter::Exporter(const std::string &path, int width, int height, std::uint64_t every, std::size_t threads)
+    : m_path(path)
+    , m_format(ends_with(path, ".y4m") ? Format::Y4M : Format::PNG)
+    , m_rasterizer(width, height)
+    , m_every(std::max<std::uint64_t>(1, every))
+    , m_last(-1)
+    , m_captured(0)
+    , m_stream()
+    , m_written(0)
+    , m_mutex()
+    , m_condition()
+    , m_frames()
+    , m_free()
+    , m_failed(false)
+    , m_pool(threads)
+{
+    for (std::size_t i = 0; i < m_pool.size() * s_frames_per_thread; i++) {
+        m_frames.push_back(std::make_unique<Frame>());
+        m_free.push_back(m_frames.back().get());
+    }
+
+    if (m_format == Format::Y4M) {
+        m_stream.open(m_path, std::ios::binary);
+
+        // Progressive 30 frames per second with square pixels, and full
+        // resolution chroma so the one pixel padding is kept.
+        m_stream << "YUV4MPEG2 W" << m_rasterizer.pixel_width()
+                 << " H" << m_rasterizer.pixel_height()
+                 << " F30:1 Ip A1:1 C444\n";
+
+        if (!m_stream)
+            m_failed = true;
+    }
+}
+
+Exporter::~Exporter()
+{
+    wait();
+}
+
+void Exporter::wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait(lock, [&]{ return m_free.size() == m_frames.size(); });
+}
+
+void Exporter::capture(GameOfLife &model)
+{
+    std::uint64_t generation = model.generation();
+    if (generation % m_every || generation == m_last || m_failed)
+        return;
+
+    Frame *frame;
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [&]{ return !m_free.empty(); });
+        frame = m_free.back();
+        m_free.pop_back();
+    }
+
+    frame->generation = model.snapshot(frame->tiles);
+    frame->sequence = m_captured++;
+    m_last = generation;
+
+    m_pool.submit([this, frame]{
+        encode(*frame);
+
+        {
+            std::scoped_lock<std::mutex> lock(m_mutex);
+            m_free.push_back(frame);
+        }
+
+        m_condition.notify_all();
+    });
+}
+
+void Exporter::encode(Frame &frame)
+{
+    frame.pixels.resize(m_rasterizer.size());
+    m_rasterizer.render(frame.tiles, frame.pixels.data());
+
+    if (m_format == Format::PNG)
+        write_png(frame);
+    else
+        write_y4m(frame);
+}
+
+void Exporter::write_png(Frame &frame)
+{
+    char number[32];
+    std::snprintf(number, sizeof(number), "%010llu", (unsigned long long)frame.generation);
+
+    sf::Image image;
+    image.create(
+        m_rasterizer.pixel_width(),
+        m_rasterizer.pixel_height(),
+        reinterpret_cast<const sf::Uint8*>(frame.pixels.data())
+    );
+
+    if (!image.saveToFile(m_path + number + ".png"))
+        m_failed = true;
+}
+
+void Exporter::write_y4m(Frame &frame)
+{
+    // Convert to BT.601 studio range YUV in parallel with other frames.
+    std::size_t size = frame.pixels.size();
+    frame.planes.resize(3 * size);
+
+    std::uint8_t *y = frame.planes.data();
+    std::uint8_t *u = y + size;
+    std::uint8_t *v = u + size;
+
+    for (std::size_t i = 0; i < size; i++) {
+        std::uint8_t rgba[4];
+        std::memcpy(rgba, &frame.pixels[i], sizeof(rgba));
+
+        int r = rgba[0];
+        int g = rgba[1];
+        int b = rgba[2];
+
+        y[i] = std::uint8_t(16 + ((66 * r + 129 * g + 25 * b + 128) >> 8));
+        u[i] = std::uint8_t(128 + ((-38 * r - 74 * g + 112 * b + 128) >> 8));
+        v[i] = std::uint8_t(128 + ((112 * r - 94 * g - 18 * b + 128) >> 8));
+    }
+
+    // Frames are written in the order they were captured. Tasks start in the
+    // order they are submitted, so every earlier frame is being encoded or
+    // already written.
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait(lock, [&]{ return m_written == frame.sequence; });
+
+    m_stream << "FRAME\n";
+    m_stream.write(reinterpret_cast<const char*>(frame.planes.data()), frame.planes.size());
+
+    if (!m_stream)
+        m_failed = true;
+
+    m_written++;
+    lock.unlock();
+    m_condition.notify_all();
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "GameOfLife.hpp"
+#include "Rasterizer.hpp"
+#include "ThreadPool.hpp"
+
+/**
+ * @brief Exports every Nth generation of a game of life as numbered PNG images
+ * or as a raw Y4M video stream, without a display.
+ * 
+ * The thread stepping the model only copies the alive tiles of a generation
+ * into a frame from a fixed pool. Rasterizing and encoding happen on a pool of
+ * encoder threads, and the frame returns to the pool once written. The model
+ * only waits when every frame is still being encoded.
+ */
+class Exporter
+{
+public:
+
+    /// The file format of exported frames.
+    enum class Format {
+
+        /// A PNG image per frame, named by the path then the generation.
+        PNG,
+
+        /// One YUV4MPEG2 stream of 4:4:4 frames.
+        Y4M
+    };
+
+    /**
+     * @brief Start exporting a game space size.
+     * 
+     * @param path The Y4M file if it ends in .y4m, otherwise the prefix of each
+     * PNG file.
+     * @param width The width of the game space in tiles.
+     * @param height The height of the game space in tiles.
+     * @param every The generations between exported frames.
+     * @param threads The number of encoder threads, or zero for one per
+     * hardware thread.
+     */
+    Exporter(const std::string &path, int width, int height, std::uint64_t every, std::size_t threads);
+
+    /**
+     * @brief Finish writing every captured frame.
+     */
+    ~Exporter();
+
+    /**
+     * @brief Wait for every captured frame to be written.
+     */
+    void wait();
+
+    /**
+     * @brief Capture the current generation if it is exported. Only called by
+     * the thread stepping the model.
+     * 
+     * @param model The game of life.
+     */
+    void capture(GameOfLife &model);
+
+    /**
+     * @brief If the output could be opened and no frame failed to write.
+     * @return If exporting succeeded so far.
+     */
+    inline bool good() const {
+        return !m_failed;
+    }
+
+    /**
+     * @brief Get the number of captured frames.
+     * @return The number of frames.
+     */
+    inline std::uint64_t frames() const {
+        return m_captured;
+    }
+
+private:
+
+    /// A pooled frame, reused once written.
+    struct Frame {
+
+        /// The generation of the frame.
+        std::uint64_t generation;
+
+        /// The order the frame was captured in.
+        std::uint64_t sequence;
+
+        /// The alive tiles.
+        std::vector<Tile> tiles;
+
+        /// The rasterized RGBA pixels.
+        std::vector<std::uint32_t> pixels;
+
+        /// The Y, U then V planes of a Y4M frame.
+        std::vector<std::uint8_t> planes;
+    };
+
+    /**
+     * @brief Rasterize, encode and write a frame on an encoder thread.
+     * @param frame The frame.
+     */
+    void encode(Frame &frame);
+
+    /**
+     * @brief Write a frame as a PNG image.
+     * @param frame The rasterized frame.
+     */
+    void write_png(Frame &frame);
+
+    /**
+     * @brief Write a frame to the Y4M stream once every earlier frame has been
+     * written.
+     * 
+     * @param frame The rasterized frame.
+     */
+    void write_y4m(Frame &frame);
+
+    /// The Y4M file, or the prefix of PNG files.
+    std::string m_path;
+
+    /// The file format.
+    Format m_format;
+
+    /// Draws the frames.
+    Rasterizer m_rasterizer;
+
+    /// The generations between exported frames.
+    std::uint64_t m_every;
+
+    /// The last generation captured, to not capture a generation twice.
+    std::uint64_t m_last;
+
+    /// The number of frames captured.
+    std::uint64_t m_captured;
+
+    /// The Y4M stream.
+    std::ofstream m_stream;
+
+    /// The sequence of the next frame written to the Y4M stream.
+    std::uint64_t m_written;
+
+    /// Mutex protecting the free frames and the written sequence.
+    std::mutex m_mutex;
+
+    /// Notified when a frame is freed or written.
+    std::condition_variable m_condition;
+
+    /// Every frame.
+    std::vector<std::unique_ptr<Frame>> m_frames;
+
+    /// The frames not being encoded.
+    std::vector<Frame*> m_free;
+
+    /// If a file could not be written.
+    std::atomic_bool m_failed;
+
+    /// The encoder threads, stopped before anything they use is destroyed.
+    ThreadPool m_pool;
+};
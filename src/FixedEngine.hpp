@@ -0,0 +1,191 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "Engine.hpp"
+
+/**
+ * @brief An engine specialised at compile time for one game space size,
+ * storing a byte per tile in a dense grid.
+ * 
+ * The row stride and the wrapping of rows and columns around the edges are
+ * constants. When a dimension is a power of two wrapping is a bit mask,
+ * otherwise the modulo is by a constant and compiles to a multiplication.
+ * The neighbor gather of the inner columns of each row has no wrapping at all
+ * so it is unrolled and vectorised.
+ * 
+ * @tparam W The width of the grid in tiles.
+ * @tparam H The height of the grid in tiles.
+ */
+template<int W, int H>
+class FixedEngine : public Engine
+{
+    static_assert(W >= 3 && H >= 3, "The grid must be at least 3 by 3.");
+
+public:
+
+    /**
+     * @brief Create an engine with an empty game space.
+     */
+    FixedEngine()
+        : Engine(W, H)
+        , m_current(W * H, 0)
+        , m_next(W * H, 0)
+    {}
+
+    void advance(std::vector<Tile> &born, std::vector<Tile> &died) override
+    {
+        if (m_rule == s_conway)
+            step<true>(born, died);
+        else
+            step<false>(born, died);
+    }
+
+    void update(int x, int y, bool alive) override
+    {
+        m_current[y * W + x] = alive;
+    }
+
+    void clear() override
+    {
+        std::fill(m_current.begin(), m_current.end(), 0);
+    }
+
+    std::string name() const override {
+        return "fixed";
+    }
+
+    std::size_t memory() const override {
+        return m_current.size() + m_next.size();
+    }
+
+private:
+
+    /**
+     * @brief Advances the game space by one generation.
+     * 
+     * @tparam Conway If the rule is Conway's, which is compared directly
+     * instead of looked up in the rule's masks.
+     * @param born Appended with each tile that became alive.
+     * @param died Appended with each tile that died.
+     */
+    template<bool Conway>
+    void step(std::vector<Tile> &born, std::vector<Tile> &died)
+    {
+        for (int y = 0; y < H; y++) {
+
+            const std::uint8_t *above = &m_current[wrap<H>(y - 1) * W];
+            const std::uint8_t *row = &m_current[y * W];
+            const std::uint8_t *below = &m_current[wrap<H>(y + 1) * W];
+            std::uint8_t *next = &m_next[y * W];
+
+            // The inner columns never wrap.
+            for (int x = 1; x < W - 1; x++) {
+                int n = above[x - 1] + above[x] + above[x + 1]
+                      + row[x - 1]              + row[x + 1]
+                      + below[x - 1] + below[x] + below[x + 1];
+
+                next[x] = state<Conway>(row[x], n);
+            }
+
+            // The first and last columns wrap to each other.
+            for (int x : {0, W - 1}) {
+                int left = wrap<W>(x - 1);
+                int right = wrap<W>(x + 1);
+
+                int n = above[left] + above[x] + above[right]
+                      + row[left]              + row[right]
+                      + below[left] + below[x] + below[right];
+
+                next[x] = state<Conway>(row[x], n);
+            }
+
+            changes(y, row, next, born, died);
+        }
+
+        m_current.swap(m_next);
+    }
+
+    /**
+     * @brief Get the next state of a tile.
+     * 
+     * @tparam Conway If the rule is Conway's.
+     * @param alive The current state of the tile.
+     * @param n The number of alive neighbors.
+     * @return The next state of the tile.
+     */
+    template<bool Conway>
+    std::uint8_t state(std::uint8_t alive, int n) const
+    {
+        if constexpr (Conway)
+            return (n == 3) | (alive & (n == 2));
+        else
+            return ((alive ? m_rule.survival : m_rule.birth) >> n) & 1;
+    }
+
+    /**
+     * @brief Wrap a coordinate one past either edge of a dimension back into
+     * the dimension.
+     * 
+     * @tparam N The size of the dimension.
+     * @param a The coordinate, between -1 and N inclusive.
+     * @return The wrapped coordinate.
+     */
+    template<int N>
+    static constexpr int wrap(int a)
+    {
+        if constexpr (std::has_single_bit(unsigned(N)))
+            return a & (N - 1);
+        else
+            return (a + N) % N;
+    }
+
+    /**
+     * @brief Append the tiles of a row that changed between generations.
+     * 
+     * Compares eight tiles at a time, since most of any row is unchanged.
+     * 
+     * @param y The row.
+     * @param row The row in the current generation.
+     * @param next The row in the next generation.
+     * @param born Appended with each tile that became alive.
+     * @param died Appended with each tile that died.
+     */
+    static void changes(
+        int y,
+        const std::uint8_t *row,
+        const std::uint8_t *next,
+        std::vector<Tile> &born,
+        std::vector<Tile> &died
+    ) {
+        int x = 0;
+
+        for (; x + 8 <= W; x += 8) {
+            std::uint64_t a, b;
+            std::memcpy(&a, row + x, 8);
+            std::memcpy(&b, next + x, 8);
+
+            if (a == b)
+                continue;
+
+            for (int i = x; i < x + 8; i++) {
+                if (row[i] != next[i])
+                    (next[i] ? born : died).push_back(Tile(i, y));
+            }
+        }
+
+        for (; x < W; x++) {
+            if (row[x] != next[x])
+                (next[x] ? born : died).push_back(Tile(x, y));
+        }
+    }
+
+    /// The state of each tile, row major.
+    std::vector<std::uint8_t> m_current;
+
+    /// The next state of each tile, swapped with the current after a step.
+    std::vector<std::uint8_t> m_next;
+};
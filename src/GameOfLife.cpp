@@ -1,15 +1,43 @@
 #include "GameOfLife.hpp"
 
+#include <algorithm>
+#include <cctype>
 #include <cmath>
-#include <unordered_map>
-#include <array>
+#include <random>
 
 GameOfLife::GameOfLife(int width, int height)
-    : m_space()
-    , m_width(width)
-    , m_height(height)
+    : GameOfLife(make_engine(width, height))
 {}
 
+GameOfLife::GameOfLife(std::unique_ptr<Engine> engine)
+    : m_engine(std::move(engine))
+    , m_born()
+    , m_died()
+    , m_pages()
+    , m_page_columns(0)
+    , m_width(m_engine->width())
+    , m_height(m_engine->height())
+    , m_row_counts(m_height, 0)
+    , m_column_counts(m_width, 0)
+    , m_bounds_dirty(false)
+    , m_tracking(false)
+    , m_changes()
+    , m_heatmap()
+    , m_population(0)
+    , m_births(0)
+    , m_deaths(0)
+    , m_generation(0)
+    , m_minimum_x(m_width)
+    , m_minimum_y(m_height)
+    , m_maximum_x(-1)
+    , m_maximum_y(-1)
+{
+    int page_tiles = s_page_size * s_chunk_size;
+
+    m_page_columns = (m_width + page_tiles - 1) / page_tiles;
+    m_pages.resize(std::size_t(m_page_columns) * ((m_height + page_tiles - 1) / page_tiles));
+}
+
 void GameOfLife::add_glider()
 {
     int x = m_width / 2;
@@ -23,132 +51,479 @@ void GameOfLife::add_glider()
     place(x + 2, y + 3);
 }
 
-std::array<Tile, 8> GameOfLife::neighbors(Tile tile)
+void GameOfLife::add_soup(double density, unsigned seed)
 {
-    // Should probably be inlined.
-
-    // Return the number wrapped around between 0 and n. If a > n, then  repeat
-    // a - n until a < n.
-    auto wrap = [](int a, int n) {
-        return ((a % n) + n) % n;
-    };
+    std::mt19937 generator(seed);
+    std::bernoulli_distribution alive(density);
 
-    // Cardinal neighbors.
-    int above = wrap(tile.y - 1, m_height);
-    int below = wrap(tile.y + 1, m_height);
-    int left = wrap(tile.x - 1, m_width);
-    int right = wrap(tile.x + 1, m_width);
-
-    // Starting with north, this is a sequence of compass directions.
-    return {
-        Tile(tile.x, above), // North
-        Tile(right, above),  // North East
-        Tile(right, tile.y), // East
-        Tile(right, below),  // South East
-        Tile(tile.x, below), // South
-        Tile(left, below),   // South West
-        Tile(left, tile.y),  // West
-        Tile(left, above)    // North West
-    };
+    for (int y = 0; y < m_height; y++) {
+        for (int x = 0; x < m_width; x++) {
+            if (alive(generator)) {
+                place(x, y);
+            }
+        }
+    }
 }
 
-int GameOfLife::count(Tile tile)
+bool GameOfLife::load(int x, int y, const std::string &pattern)
 {
-    int n = 0;
+    // No run longer than the game space fits in it, so rejecting those keeps
+    // the counts from overflowing.
+    int longest = std::max(m_width, m_height);
+    int run = 0;
+
+    // Validate the whole pattern before placing any of it.
+    for (unsigned char c : pattern) {
+        if (std::isdigit(c)) {
+            run = run * 10 + (c - '0');
+            if (run > longest)
+                return false;
+        }
+        else if (c != 'b' && c != 'o' && c != '$' && c != '!' && !std::isspace(c)) {
+            return false;
+        }
+        else {
+            run = 0;
+        }
+    }
+
+    // Wide enough that a run past the game space cannot overflow, as the
+    // column stops at the right edge.
+    std::int64_t column = x;
+    std::int64_t row = y;
+    run = 0;
+
+    for (unsigned char c : pattern) {
+        if (std::isdigit(c)) {
+            run = run * 10 + (c - '0');
+            continue;
+        }
+
+        int n = run ? run : 1;
+        run = 0;
+
+        if (c == 'b') {
+            column = std::min<std::int64_t>(column + n, m_width);
+        }
+        else if (c == 'o') {
+            // Only the span of the run inside the game space is placed.
+            if (row >= 0) {
+                std::int64_t last = std::min<std::int64_t>(column + n, m_width);
+                for (std::int64_t i = std::max<std::int64_t>(column, 0); i < last; i++)
+                    place(int(i), int(row));
+            }
+
+            column = std::min<std::int64_t>(column + n, m_width);
+        }
+        else if (c == '$') {
+            column = x;
+            row += n;
 
-    // Increment all neighbors.
-    for (auto neighbor : neighbors(tile)) {
-        if (m_space.contains(neighbor)) {
-            n++;
+            // The rest of the pattern is below the game space.
+            if (row >= m_height)
+                break;
         }
+        else if (c == '!') {
+            break;
+        }
+    }
+
+    return true;
+}
+
+std::string GameOfLife::save()
+{
+    std::vector<Tile> tiles;
+    snapshot(tiles);
+
+    std::sort(tiles.begin(), tiles.end(), [](Tile a, Tile b) {
+        return a.y < b.y || (a.y == b.y && a.x < b.x);
+    });
+
+    std::string pattern;
+
+    // Append a run of a tag, omitting a count of one.
+    auto run = [&](int n, char tag) {
+        if (n > 1)
+            pattern += std::to_string(n);
+        if (n > 0)
+            pattern += tag;
     };
 
-    return n;
+    int row = 0;
+    int column = 0;
+
+    for (std::size_t i = 0; i < tiles.size();) {
+
+        run(tiles[i].y - row, '$');
+        if (tiles[i].y != row)
+            column = 0;
+        row = tiles[i].y;
+
+        // The run of alive tiles starting at this one.
+        std::size_t j = i + 1;
+        while (j < tiles.size() && tiles[j].y == row && tiles[j].x == tiles[j - 1].x + 1)
+            j++;
+
+        run(tiles[i].x - column, 'b');
+        run(j - i, 'o');
+        column = tiles[j - 1].x + 1;
+
+        i = j;
+    }
+
+    return pattern + "!";
 }
 
 void GameOfLife::advance()
 {
-    /// @todo Multithreading with a std::latch and a thread pool. This algorithm
-    /// is threadable because it only reads from the current game space when
-    /// calculating the next iteration.
+    std::scoped_lock<std::mutex> lock(m_mutex);
+
+    m_born.clear();
+    m_died.clear();
 
-    // Surrounding alive counts of each tile.
-    std::unordered_map<Tile, int> counts;
+    m_engine->advance(m_born, m_died);
 
-    for (auto tile : m_space) {
+    record_changes();
+    m_generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+void GameOfLife::advance(std::uint64_t generations)
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
 
-        int n = 0;
+    m_born.clear();
+    m_died.clear();
 
-        // Count the number of alive neighbors. For all the dead neighbors,
-        // count their alive neighbors if they are not already counted.
-        for (auto neighbor : neighbors(tile)) {
-            if (m_space.contains(neighbor)) {
-                n++;
-            }
-            else if (!counts.contains(neighbor)) {
-                counts.emplace(neighbor, count(neighbor));
-            }
-        };
+    m_engine->advance_batch(generations, m_born, m_died);
 
-        counts.emplace(tile, n);
+    record_changes();
+    m_generation.fetch_add(generations, std::memory_order_relaxed);
+}
+
+void GameOfLife::record_changes()
+{
+    for (Tile tile : m_born) {
+        record_birth(tile);
     }
 
-    // Lock during write only.
-    std::scoped_lock<std::mutex> lock(m_mutex);
+    for (Tile tile : m_died) {
+        record_death(tile);
+    }
 
-    // These lines of code make up the logic of the simulation!
-    for (auto [tile, n] : counts) {
+    // Every writer of the population holds the mutex, so it is updated once
+    // per step rather than once per tile.
+    m_population.store(
+        m_population.load(std::memory_order_relaxed) + m_born.size() - m_died.size(),
+        std::memory_order_relaxed
+    );
 
-        // If the tile was alive last iteration.
-        auto it = m_space.find(tile);
-        bool alive = it != m_space.end();
+    if (m_tracking) {
+        for (Tile tile : m_died) {
+            m_changes.push_back(Change(tile, false));
+        }
 
-        if (alive && (n == 2 || n == 3)) {
-            continue;
+        for (Tile tile : m_born) {
+            m_changes.push_back(Change(tile, true));
         }
-        else if (!alive && n == 3) {
-            m_space.insert(tile);
+    }
+
+    if (!m_heatmap.empty()) {
+        for (Tile tile : m_born) {
+            m_heatmap[tile.y * m_width + tile.x]++;
         }
-        else if (alive) {
-            m_space.erase(it);
+
+        for (Tile tile : m_died) {
+            m_heatmap[tile.y * m_width + tile.x]++;
         }
     }
+
+    shrink_bounds();
+
+    m_births.store(m_born.size(), std::memory_order_relaxed);
+    m_deaths.store(m_died.size(), std::memory_order_relaxed);
+}
+
+std::size_t GameOfLife::count_in(Region region)
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    std::size_t n = 0;
+
+    for_each_chunk_in(region, [&](Tile, std::uint64_t bits) {
+        n += std::popcount(bits);
+    });
+
+    return n;
 }
 
 std::unordered_set<Tile> GameOfLife::space()
 {
-    std::scoped_lock<std::mutex> space_lock(m_mutex);
-    return m_space;
+    std::unordered_set<Tile> space;
+    space.reserve(population());
+
+    for_each_alive_in(Region(0, 0, m_width, m_height), [&](Tile tile) {
+        space.insert(tile);
+    });
+
+    return space;
+}
+
+std::uint64_t GameOfLife::snapshot(std::vector<Tile> &tiles)
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+
+    tiles.clear();
+    for_each_tile_in(Region(0, 0, m_width, m_height), [&](Tile tile) {
+        tiles.push_back(tile);
+    });
+
+    return m_generation.load(std::memory_order_relaxed);
 }
 
-void GameOfLife::update(int x, int y, bool value)
+std::uint64_t GameOfLife::update(int x, int y, bool value)
 {
     std::scoped_lock<std::mutex> lock(m_mutex);
 
+    // Read under the mutex, so advance() cannot step between the update and
+    // the generation.
+    std::uint64_t generation = m_generation.load(std::memory_order_relaxed);
+
     // If the position is out of bounds then do nothing.
-    if (x > m_width || x < 0 || y > m_height || y < 0) {
-        return;
+    if (x >= m_width || x < 0 || y >= m_height || y < 0) {
+        return generation;
     }
 
     Tile tile {x, y};
 
-    // Try to find the tile if it exists.
-    auto it = m_space.find(tile);
+    // Only tell the engine about tiles that change.
+    if (contains(tile) == value) {
+        return generation;
+    }
+
+    m_engine->update(x, y, value);
 
-    if (it == m_space.end()) {
-        if (value) {
-            m_space.insert(it, tile);
-        }
+    if (m_tracking) {
+        m_changes.push_back(Change(tile, value));
+    }
+
+    if (value) {
+        record_birth(tile);
+        m_population.fetch_add(1, std::memory_order_relaxed);
     }
     else {
-        if (!value) {
-            m_space.erase(it);
-        }
+        record_death(tile);
+        m_population.fetch_sub(1, std::memory_order_relaxed);
+        shrink_bounds();
     }
+
+    return generation;
 }
 
-void GameOfLife::clear()
+std::uint64_t GameOfLife::clear()
 {
     std::scoped_lock<std::mutex> lock(m_mutex);
-    m_space.clear();
+    if (m_tracking) {
+        for_each_tile_in(Region(0, 0, m_width, m_height), [&](Tile tile) {
+            m_changes.push_back(Change(tile, false));
+        });
+    }
+
+    m_engine->clear();
+
+    for (Page &page : m_pages) {
+        page.occupied = 0;
+        page.chunks = std::vector<std::uint64_t>();
+    }
+
+    std::fill(m_row_counts.begin(), m_row_counts.end(), 0);
+    std::fill(m_column_counts.begin(), m_column_counts.end(), 0);
+    m_bounds_dirty = true;
+    m_population.store(0, std::memory_order_relaxed);
+    shrink_bounds();
+
+    return m_generation.load(std::memory_order_relaxed);
+}
+
+void GameOfLife::heatmap(bool enabled)
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+
+    if (enabled) {
+        m_heatmap.assign(m_width * m_height, 0);
+    }
+    else {
+        m_heatmap = std::vector<std::uint32_t>();
+    }
+}
+
+std::vector<std::uint32_t> GameOfLife::heatmap()
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    return m_heatmap;
+}
+
+void GameOfLife::track_changes(bool enabled)
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+
+    m_tracking = enabled;
+    m_changes.clear();
+}
+
+std::uint64_t GameOfLife::take_changes(std::vector<Change> &changes)
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+
+    m_changes.swap(changes);
+    return m_generation.load(std::memory_order_relaxed);
+}
+
+void GameOfLife::rule(Rule rule)
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    m_engine->rule(rule);
+}
+
+Rule GameOfLife::rule()
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    return m_engine->rule();
+}
+
+std::string GameOfLife::engine()
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    return m_engine->name();
+}
+
+int GameOfLife::depth()
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    return m_engine->depth();
+}
+
+std::size_t GameOfLife::memory()
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+
+    std::size_t memory = m_engine->memory()
+        + m_pages.capacity() * sizeof(Page)
+        + (m_row_counts.capacity() + m_column_counts.capacity()) * sizeof(int)
+        + (m_born.capacity() + m_died.capacity()) * sizeof(Tile)
+        + m_changes.capacity() * sizeof(Change)
+        + m_heatmap.capacity() * sizeof(std::uint32_t);
+
+    for (const Page &page : m_pages)
+        memory += page.chunks.capacity() * sizeof(std::uint64_t);
+
+    return memory;
+}
+
+bool GameOfLife::contains(Tile tile) const
+{
+    Tile chunk {tile.x / s_chunk_size, tile.y / s_chunk_size};
+    const Page &page = m_pages[page_index(chunk)];
+    int bit = page_bit(chunk);
+
+    return (page.occupied >> bit & 1)
+        && (page.chunks[page_rank(page, bit)] >> chunk_bit(tile) & 1);
+}
+
+void GameOfLife::record_birth(Tile tile)
+{
+    m_row_counts[tile.y]++;
+    m_column_counts[tile.x]++;
+
+    Tile chunk {tile.x / s_chunk_size, tile.y / s_chunk_size};
+    Page &page = m_pages[page_index(chunk)];
+    int bit = page_bit(chunk);
+    int rank = page_rank(page, bit);
+
+    if (!(page.occupied >> bit & 1)) {
+        page.occupied |= std::uint64_t(1) << bit;
+        page.chunks.insert(page.chunks.begin() + rank, 0);
+    }
+
+    page.chunks[rank] |= std::uint64_t(1) << chunk_bit(tile);
+
+    // The bounds grow eagerly, this is only ever a comparison.
+    if (tile.x < m_minimum_x.load(std::memory_order_relaxed))
+        m_minimum_x.store(tile.x, std::memory_order_relaxed);
+    if (tile.y < m_minimum_y.load(std::memory_order_relaxed))
+        m_minimum_y.store(tile.y, std::memory_order_relaxed);
+    if (tile.x > m_maximum_x.load(std::memory_order_relaxed))
+        m_maximum_x.store(tile.x, std::memory_order_relaxed);
+    if (tile.y > m_maximum_y.load(std::memory_order_relaxed))
+        m_maximum_y.store(tile.y, std::memory_order_relaxed);
+}
+
+void GameOfLife::record_death(Tile tile)
+{
+    // Forget chunks as soon as they empty so queries only visit occupied ones,
+    // and release pages as soon as they empty.
+    Tile chunk {tile.x / s_chunk_size, tile.y / s_chunk_size};
+    Page &page = m_pages[page_index(chunk)];
+    int bit = page_bit(chunk);
+    int rank = page_rank(page, bit);
+
+    page.chunks[rank] &= ~(std::uint64_t(1) << chunk_bit(tile));
+
+    if (page.chunks[rank] == 0) {
+        page.occupied &= ~(std::uint64_t(1) << bit);
+        page.chunks.erase(page.chunks.begin() + rank);
+
+        if (page.occupied == 0) {
+            page.chunks = std::vector<std::uint64_t>();
+        }
+    }
+
+    // The bounds only need shrinking when a row or column on its edge empties.
+    if (--m_row_counts[tile.y] == 0) {
+        if (tile.y == m_minimum_y.load(std::memory_order_relaxed) ||
+            tile.y == m_maximum_y.load(std::memory_order_relaxed)) {
+            m_bounds_dirty = true;
+        }
+    }
+
+    if (--m_column_counts[tile.x] == 0) {
+        if (tile.x == m_minimum_x.load(std::memory_order_relaxed) ||
+            tile.x == m_maximum_x.load(std::memory_order_relaxed)) {
+            m_bounds_dirty = true;
+        }
+    }
+}
+
+void GameOfLife::shrink_bounds()
+{
+    if (!m_bounds_dirty) {
+        return;
+    }
+
+    m_bounds_dirty = false;
+
+    // An empty space has an inverted bounding box.
+    if (m_population.load(std::memory_order_relaxed) == 0) {
+        m_minimum_x.store(m_width, std::memory_order_relaxed);
+        m_minimum_y.store(m_height, std::memory_order_relaxed);
+        m_maximum_x.store(-1, std::memory_order_relaxed);
+        m_maximum_y.store(-1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Walk each edge inwards until it reaches an occupied row or column. At
+    // least one tile is alive, so each walk stops inside the space.
+    int minimum_x = m_minimum_x.load(std::memory_order_relaxed);
+    int minimum_y = m_minimum_y.load(std::memory_order_relaxed);
+    int maximum_x = m_maximum_x.load(std::memory_order_relaxed);
+    int maximum_y = m_maximum_y.load(std::memory_order_relaxed);
+
+    while (m_column_counts[minimum_x] == 0) minimum_x++;
+    while (m_column_counts[maximum_x] == 0) maximum_x--;
+    while (m_row_counts[minimum_y] == 0) minimum_y++;
+    while (m_row_counts[maximum_y] == 0) maximum_y--;
+
+    m_minimum_x.store(minimum_x, std::memory_order_relaxed);
+    m_minimum_y.store(minimum_y, std::memory_order_relaxed);
+    m_maximum_x.store(maximum_x, std::memory_order_relaxed);
+    m_maximum_y.store(maximum_y, std::memory_order_relaxed);
 }
@@ -1,29 +1,18 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
 #include <mutex>
+#include <string>
 #include <unordered_set>
+#include <vector>
 
-/// Type describing a tile.
-struct Tile {
-    int x;
-    int y;
-};
-
-// Hash function for Tile.
-template<>
-struct std::hash<Tile>
-{
-    size_t operator()(const Tile& tile) const noexcept
-    {
-        size_t hx = hash<int>{}(tile.x);
-        size_t hy = hash<int>{}(tile.y);
-        return hx ^ (hy + 0x9e3779b9 + (hx << 6) + (hx >> 2));
-    }
-};
-
-inline bool operator==(const Tile &left, const Tile &right) {
-    return left.x == right.x && left.y == right.y;
-}
+#include "Engine.hpp"
+#include "Tile.hpp"
 
 /**
  * @brief Class implementing Conways game of life.
@@ -41,30 +30,109 @@ public:
     /// Type describing all alive tiles.
     using Space = std::unordered_set<Tile>;
 
+    /// The width and height in tiles of each chunk in the spatial index.
+    static constexpr int s_chunk_size = 8;
+
     /**
      * @brief Instantiate a game of life with a grid of provided width and 
-     * height.
+     * height, stepped by the fastest engine for that size.
      * 
      * @param width The width of the grid in tiles.
      * @param height The height of the grid in tiles.
      */
     GameOfLife(int width, int height);
 
+    /**
+     * @brief Instantiate a game of life stepped by an engine, with the width
+     * and height of the engine's grid. The engine must be empty.
+     * 
+     * @param engine The engine stepping the game space.
+     */
+    GameOfLife(std::unique_ptr<Engine> engine);
+
     /**
      * @brief Add a glider to the centre of the game space.
      */
     void add_glider();
 
+    /**
+     * @brief Set tiles alive at random.
+     * 
+     * @param density The probability of each tile being set alive.
+     * @param seed The seed of the random number generator.
+     */
+    void add_soup(double density, unsigned seed);
+
+    /**
+     * @brief Set the tiles of a pattern in run length encoded (RLE) format
+     * alive, with its top left at (x, y). Tiles outside the game space are
+     * ignored.
+     * 
+     * @param x The x position of the pattern in the grid.
+     * @param y The y position of the pattern in the grid.
+     * @param pattern The RLE pattern body, such as "bo$2bo$3o!" for a glider.
+     * @return If the pattern is valid, with no run longer than the game space.
+     */
+    bool load(int x, int y, const std::string &pattern);
+
+    /**
+     * @brief Gets the whole game space as a run length encoded (RLE) pattern
+     * body, that load() restores.
+     * 
+     * @return The RLE pattern body.
+     */
+    std::string save();
+
     /**
      * @brief Advances the game of life state by one step.
      */
     void advance();
 
+    /**
+     * @brief Advances the game of life state by many steps at once, through
+     * Engine::advance_batch(). The births, deaths, changes and heatmap only
+     * see the tiles that differ from before the steps, so this is for callers
+     * that do not observe each generation.
+     * 
+     * @param generations The number of generations.
+     */
+    void advance(std::uint64_t generations);
+
     /**
      * @brief Gets the alive tiles
      */
     std::unordered_set<Tile> space();
 
+    /**
+     * @brief Gets the alive tiles and the generation they are from.
+     * 
+     * @param tiles Assigned the alive tiles.
+     * @return The generation of the tiles.
+     */
+    std::uint64_t snapshot(std::vector<Tile> &tiles);
+
+    /**
+     * @brief Calls a function with every alive tile inside a region. The
+     * function is called with the mutex held and must not call back into the
+     * game of life.
+     * 
+     * Takes time proportional to the pages of chunks overlapping the region
+     * and the occupied chunks in them.
+     * 
+     * @param region The region of tiles to search.
+     * @param function Callable with each alive Tile in the region.
+     */
+    template<typename Function>
+    void for_each_alive_in(Region region, Function &&function);
+
+    /**
+     * @brief Counts the alive tiles inside a region.
+     * 
+     * @param region The region of tiles to count.
+     * @return The number of alive tiles in the region.
+     */
+    std::size_t count_in(Region region);
+
     /**
      * @brief Updates the value of a tile at position (x, y) to alive or not. If
      * the position is out of bounds then does nothing.
@@ -72,8 +140,9 @@ public:
      * @param x The x position in the grid.
      * @param y The y position in the grid.
      * @param alive If that position is alive.
+     * @return The generation the update was applied before.
      */
-    void update(int x, int y, bool alive);
+    std::uint64_t update(int x, int y, bool alive);
 
     /**
      * @brief Sets a tile to alive at (x, y). If the position is out of bounds
@@ -81,9 +150,10 @@ public:
      * 
      * @param x The x position in the grid.
      * @param y The y position in the grid.
+     * @return The generation the tile was placed before.
      */
-    inline void place(int x, int y) {
-        update(x, y, true);
+    inline std::uint64_t place(int x, int y) {
+        return update(x, y, true);
     }
 
     /**
@@ -92,15 +162,17 @@ public:
      * 
      * @param x The x position in the grid.
      * @param y The y position in the grid.
+     * @return The generation the tile was removed before.
      */
-    inline void remove(int x, int y) {
-        update(x, y, false);
+    inline std::uint64_t remove(int x, int y) {
+        return update(x, y, false);
     }
 
     /**
      * @brief Sets all tiles to dead.
+     * @return The generation the tiles were cleared before.
      */
-    void clear();
+    std::uint64_t clear();
 
     /**
      * @brief Get the width of the simulation space.
@@ -118,26 +190,293 @@ public:
         return m_height;
     }
 
+    /**
+     * @brief Set the rule of each following advance().
+     * @param rule The rule.
+     */
+    void rule(Rule rule);
+
+    /**
+     * @brief Get the rule the game space advances by.
+     * @return The rule.
+     */
+    Rule rule();
+
+    /**
+     * @brief Get the name of the engine stepping the game space.
+     * @return The name of the engine.
+     */
+    std::string engine();
+
+    /**
+     * @brief Get the generations each pass of the engine advances.
+     * @return The depth of the engine.
+     */
+    int depth();
+
+    /**
+     * @brief Get the memory the game space occupies, in the engine and in the
+     * spatial index, statistics, changes and heatmap kept here.
+     * @return The approximate size of the game space in bytes.
+     */
+    std::size_t memory();
+
+    /**
+     * @brief Get the number of alive tiles.
+     * @return The number of alive tiles.
+     */
+    inline std::size_t population() const {
+        return m_population.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the number of tiles that became alive in the last generation.
+     * @return The number of births in the last generation.
+     */
+    inline std::size_t births() const {
+        return m_births.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the number of tiles that died in the last generation.
+     * @return The number of deaths in the last generation.
+     */
+    inline std::size_t deaths() const {
+        return m_deaths.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the number of generations advanced since construction.
+     * @return The generation number.
+     */
+    inline std::uint64_t generation() const {
+        return m_generation.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the smallest tile containing all alive tiles, inclusive.
+     * 
+     * Each corner is loaded independently, so a reader concurrent with
+     * advance() may observe corners from adjacent generations.
+     * 
+     * @return The minimum corner of the bounding box. If there are no alive
+     * tiles then the minimum is greater than the maximum.
+     */
+    inline Tile bounds_minimum() const {
+        return Tile(
+            m_minimum_x.load(std::memory_order_relaxed),
+            m_minimum_y.load(std::memory_order_relaxed)
+        );
+    }
+
+    /**
+     * @brief Get the largest tile containing all alive tiles, inclusive.
+     * @return The maximum corner of the bounding box.
+     */
+    inline Tile bounds_maximum() const {
+        return Tile(
+            m_maximum_x.load(std::memory_order_relaxed),
+            m_maximum_y.load(std::memory_order_relaxed)
+        );
+    }
+
+    /**
+     * @brief Enable or disable the activity heatmap. Enabling resets every
+     * count to zero, disabling releases the heatmap.
+     * 
+     * @param enabled If the heatmap accumulates activity.
+     */
+    void heatmap(bool enabled);
+
+    /**
+     * @brief Gets the cumulative number of times each tile changed state during
+     * advance() since the heatmap was enabled.
+     * 
+     * @return Row major counts of width * height tiles, or empty if the heatmap
+     * is disabled.
+     */
+    std::vector<std::uint32_t> heatmap();
+
+    /**
+     * @brief Enable or disable recording every change of tile state, from both
+     * advance() and update(), for take_changes(). Disabling discards any
+     * recorded changes.
+     * 
+     * @param enabled If changes are recorded.
+     */
+    void track_changes(bool enabled);
+
+    /**
+     * @brief Takes the changes recorded since the last call, in the order they
+     * happened.
+     * 
+     * @param changes Swapped with the recorded changes, and should be empty.
+     * @return The generation after the last change.
+     */
+    std::uint64_t take_changes(std::vector<Change> &changes);
+
 private:
 
     /**
-     * @brief Returns all the neighboring tiles of a tile.
+     * @brief Check if a tile is alive using the spatial index. Must be called
+     * with the mutex held.
+     * 
+     * @param tile The tile, inside the game space.
+     * @return If the tile is alive.
+     */
+    bool contains(Tile tile) const;
+
+    /**
+     * @brief Record a tile becoming alive in the spatial index and
+     * statistics, except the population the caller updates. Must be called
+     * with the mutex held.
+     * 
+     * @param tile The tile that became alive.
+     */
+    void record_birth(Tile tile);
+
+    /**
+     * @brief Record a tile dying in the spatial index and statistics, except
+     * the population the caller updates. Must be called with the mutex held.
+     * 
+     * @param tile The tile that died.
+     */
+    void record_death(Tile tile);
+
+    /**
+     * @brief Record the tiles the engine reported born and died in the
+     * statistics, changes and heatmap. Must be called with the mutex held.
+     */
+    void record_changes();
+
+    /**
+     * @brief Shrink the bounding box past rows and columns that no longer have
+     * any alive tiles. Must be called with the mutex held.
+     */
+    void shrink_bounds();
+
+    /**
+     * @brief Calls a function with the chunk coordinate and bits of every
+     * occupied chunk overlapping a region, masked to the tiles inside it. Must
+     * be called with the mutex held.
+     * 
+     * @param region The region of tiles, clipped to the game space.
+     * @param function Callable with the chunk Tile and its std::uint64_t bits.
+     */
+    template<typename Function>
+    void for_each_chunk_in(Region region, Function &&function);
+
+    /**
+     * @brief Calls a function with every alive tile inside a region. Must be
+     * called with the mutex held.
+     * 
+     * @param region The region of tiles to search.
+     * @param function Callable with each alive Tile in the region.
+     */
+    template<typename Function>
+    void for_each_tile_in(Region region, Function &&function);
+
+    /**
+     * @brief Get the index of a tile's bit within its chunk.
+     * 
+     * @param tile The tile, inside the game space.
+     * @return The bit index of the tile.
+     */
+    static inline int chunk_bit(Tile tile) {
+        return (tile.y % s_chunk_size) * s_chunk_size + tile.x % s_chunk_size;
+    }
+
+    /**
+     * @brief Get the bits of a square of 8 by 8, row major, that lie inside
+     * an inclusive rectangle clipped to it.
+     * 
+     * @param x0 The left column.
+     * @param x1 The right column.
+     * @param y0 The top row.
+     * @param y1 The bottom row.
+     * @return The bits inside the rectangle.
+     */
+    static inline std::uint64_t square_mask(int x0, int x1, int y0, int y1) {
+        x0 = std::max(x0, 0);
+        x1 = std::min(x1, 7);
+        y0 = std::max(y0, 0);
+        y1 = std::min(y1, 7);
+
+        std::uint64_t row = ((std::uint64_t(1) << (x1 + 1)) - 1) >> x0 << x0;
+        std::uint64_t bits = 0;
+
+        for (int y = y0; y <= y1; y++) {
+            bits |= row << (y * 8);
+        }
+
+        return bits;
+    }
+
+    /// The width and height in chunks of each page of the spatial index.
+    static constexpr int s_page_size = 8;
+
+    /// A square of chunks in the spatial index, storing only occupied chunks.
+    struct Page {
+
+        /// A row major bit per chunk, set if the chunk is occupied.
+        std::uint64_t occupied = 0;
+
+        /// The bits of each occupied chunk, in the order of their bits in
+        /// occupied.
+        std::vector<std::uint64_t> chunks;
+    };
+
+    /**
+     * @brief Get the index of the page of the spatial index containing a
+     * chunk.
+     * 
+     * @param chunk The coordinate of the chunk.
+     * @return The index of the page in the pages.
+     */
+    inline std::size_t page_index(Tile chunk) const {
+        return std::size_t(chunk.y / s_page_size) * m_page_columns + chunk.x / s_page_size;
+    }
+
+    /**
+     * @brief Get the index of a chunk's bit within its page.
      * 
-     * @param tile The tile to find the neighbors of.
-     * @return The neighboring tiles.
+     * @param chunk The coordinate of the chunk.
+     * @return The bit index of the chunk.
      */
-    std::array<Tile, 8> neighbors(Tile tile);
+    static inline int page_bit(Tile chunk) {
+        return (chunk.y % s_page_size) * s_page_size + chunk.x % s_page_size;
+    }
 
     /**
-     * @brief Returns the number of alive tiles around one.
+     * @brief Get the position in a page's chunks of an occupied chunk, or
+     * where it is inserted if unoccupied.
      * 
-     * @param tile The tile to count the number of alive tiles around.
-     * @return The number of alive tiles surrounding the tile.
+     * @param page The page.
+     * @param bit The bit index of the chunk within the page.
+     * @return The position of the chunk.
      */
-    int count(Tile tile);
+    static inline int page_rank(const Page &page, int bit) {
+        return std::popcount(page.occupied & ((std::uint64_t(1) << bit) - 1));
+    }
+
+
+    /// The engine stepping the game space.
+    std::unique_ptr<Engine> m_engine;
+
+    /// Tiles that became alive in the last step of the engine.
+    std::vector<Tile> m_born;
 
-    /// Vector of width * height booleans with the state of each square.
-    Space m_space;
+    /// Tiles that died in the last step of the engine.
+    std::vector<Tile> m_died;
+
+    /// Spatial index of the alive tiles, row major pages of chunks covering
+    /// the game space. Each occupied chunk stores a row major bit per tile,
+    /// with bit 0 at the top left. Looking up a chunk is only indexing, and
+    /// the memory follows the occupied chunks.
+    std::vector<Page> m_pages;
+
+    /// The number of pages in each row of pages.
+    int m_page_columns;
 
     /// Mutex protecting concurrent access to the game space.
     std::mutex m_mutex;
@@ -147,4 +486,110 @@ private:
 
     /// The height of the game space.
     int m_height;
+
+    /// The number of alive tiles in each row, used to shrink the bounds.
+    std::vector<int> m_row_counts;
+
+    /// The number of alive tiles in each column, used to shrink the bounds.
+    std::vector<int> m_column_counts;
+
+    /// If a row or column on the edge of the bounds has emptied.
+    bool m_bounds_dirty;
+
+    /// If changes are recorded.
+    bool m_tracking;
+
+    /// The changes recorded since the last call to take_changes().
+    std::vector<Change> m_changes;
+
+    /// Number of state changes of each tile, empty if disabled.
+    std::vector<std::uint32_t> m_heatmap;
+
+    /// The number of alive tiles.
+    std::atomic_size_t m_population;
+
+    /// The number of births in the last generation.
+    std::atomic_size_t m_births;
+
+    /// The number of deaths in the last generation.
+    std::atomic_size_t m_deaths;
+
+    /// The number of generations advanced.
+    std::atomic_uint64_t m_generation;
+
+    /// The inclusive bounding box of alive tiles.
+    std::atomic_int m_minimum_x;
+    std::atomic_int m_minimum_y;
+    std::atomic_int m_maximum_x;
+    std::atomic_int m_maximum_y;
 };
+
+template<typename Function>
+void GameOfLife::for_each_chunk_in(Region region, Function &&function)
+{
+    // Clip the region to the game space, wide enough that a region from a
+    // client reaching past it cannot overflow.
+    int left = std::max(region.x, 0);
+    int top = std::max(region.y, 0);
+    int right = int(std::min<std::int64_t>(std::int64_t(region.x) + region.width, m_width)) - 1;
+    int bottom = int(std::min<std::int64_t>(std::int64_t(region.y) + region.height, m_height)) - 1;
+
+    if (left > right || top > bottom || population() == 0) {
+        return;
+    }
+
+    Tile first {left / s_chunk_size, top / s_chunk_size};
+    Tile last {right / s_chunk_size, bottom / s_chunk_size};
+
+    // Visit the occupied chunks inside the region of each page overlapping
+    // it, skipping unoccupied chunks a word at a time.
+    for (int py = first.y / s_page_size; py <= last.y / s_page_size; py++) {
+        for (int px = first.x / s_page_size; px <= last.x / s_page_size; px++) {
+
+            const Page &page = m_pages[std::size_t(py) * m_page_columns + px];
+
+            std::uint64_t inside = page.occupied & square_mask(
+                first.x - px * s_page_size, last.x - px * s_page_size,
+                first.y - py * s_page_size, last.y - py * s_page_size
+            );
+
+            while (inside) {
+                int bit = std::countr_zero(inside);
+                inside &= inside - 1;
+
+                Tile chunk {px * s_page_size + bit % s_page_size, py * s_page_size + bit / s_page_size};
+
+                // Bits of the tiles in the chunk that lie inside the region.
+                std::uint64_t mask = square_mask(
+                    left - chunk.x * s_chunk_size, right - chunk.x * s_chunk_size,
+                    top - chunk.y * s_chunk_size, bottom - chunk.y * s_chunk_size
+                );
+
+                function(chunk, page.chunks[page_rank(page, bit)] & mask);
+            }
+        }
+    }
+}
+
+template<typename Function>
+void GameOfLife::for_each_alive_in(Region region, Function &&function)
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    for_each_tile_in(region, function);
+}
+
+template<typename Function>
+void GameOfLife::for_each_tile_in(Region region, Function &&function)
+{
+    for_each_chunk_in(region, [&](Tile chunk, std::uint64_t bits) {
+        while (bits) {
+            int bit = std::countr_zero(bits);
+            bits &= bits - 1;
+
+            function(Tile(
+                chunk.x * s_chunk_size + bit % s_chunk_size,
+                chunk.y * s_chunk_size + bit / s_chunk_size
+            ));
+        }
+    });
+}
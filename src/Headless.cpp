@@ -0,0 +1,97 @@
+#include "Headless.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+
+namespace {
+
+/// Set by the interrupt signal to stop the run.
+std::atomic_bool s_interrupted = false;
+
+/// The passes of the engine's depth in each batch of generations.
+constexpr std::uint64_t s_batch_passes = 8;
+
+}
+
+Headless::Headless(const Options &options, std::unique_ptr<Engine> engine)
+    : m_model(std::move(engine))
+    , m_server()
+    , m_exporter()
+    , m_generations(options.generations)
+    , m_batch(1)
+{
+    if (options.soup > 0)
+        m_model.add_soup(options.soup, options.seed);
+    else
+        m_model.add_glider();
+
+    if (options.serve)
+        m_server = std::make_unique<Server>(m_model, options.serve);
+
+    if (!options.export_path.empty()) {
+        m_exporter = std::make_unique<Exporter>(
+            options.export_path, m_model.width(), m_model.height(), options.export_every, options.threads
+        );
+    }
+
+    // Without observers of each generation, an engine advancing several
+    // generations per pass advances a batch of passes at once.
+    if (!m_server && !m_exporter && m_model.depth() > 1)
+        m_batch = std::uint64_t(m_model.depth()) * s_batch_passes;
+}
+
+int Headless::run()
+{
+    using namespace std::chrono;
+
+    std::signal(SIGINT, [](int) { s_interrupted = true; });
+
+    steady_clock::time_point start = steady_clock::now();
+
+    if (m_exporter)
+        m_exporter->capture(m_model);
+
+    while (!s_interrupted && (m_generations == 0 || m_model.generation() < m_generations)) {
+        std::uint64_t generations = m_generations == 0
+            ? m_batch
+            : std::min(m_batch, m_generations - m_model.generation());
+
+        if (generations > 1)
+            m_model.advance(generations);
+        else
+            m_model.advance();
+
+        if (m_server)
+            m_server->publish();
+
+        if (m_exporter)
+            m_exporter->capture(m_model);
+    }
+
+    double seconds = duration_cast<duration<double>>(steady_clock::now() - start).count();
+    std::size_t memory = m_model.memory();
+
+    std::cout << "Engine:      " << m_model.engine() << "\n"
+              << "Generations: " << m_model.generation() << "\n"
+              << "Seconds:     " << seconds << "\n"
+              << "Rate:        " << m_model.generation() / seconds << " generations/s\n"
+              << "Population:  " << m_model.population() << "\n"
+              << "Memory:      " << memory / 1024.0 << " KiB, "
+              << double(memory) / std::max<std::uint64_t>(1, m_model.population()) << " bytes/tile\n";
+
+    if (m_exporter) {
+        m_exporter->wait();
+
+        std::cout << "Frames:      " << m_exporter->frames() << "\n";
+
+        if (!m_exporter->good()) {
+            std::cerr << "Failed to write exported frames.\n";
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <memory>
+
+#include "Exporter.hpp"
+#include "GameOfLife.hpp"
+#include "Options.hpp"
+#include "Server.hpp"
+
+/**
+ * @brief Runs a game of life as fast as possible without a window, for long
+ * runs on machines without a display.
+ */
+class Headless
+{
+public:
+
+    /**
+     * @brief Create the game of life described by the options.
+     * 
+     * @param options The command line options.
+     * @param engine The engine advancing the game of life.
+     */
+    Headless(const Options &options, std::unique_ptr<Engine> engine);
+
+    /**
+     * @brief Advance until the requested number of generations or until
+     * interrupted, then print the statistics.
+     * 
+     * @return The exit code of the application.
+     */
+    int run();
+
+private:
+
+    /// The game of life being run.
+    GameOfLife m_model;
+
+    /// Server of the observer stream, if serving.
+    std::unique_ptr<Server> m_server;
+
+    /// Exporter of frames, if exporting.
+    std::unique_ptr<Exporter> m_exporter;
+
+    /// The number of generations to run, or zero to run until interrupted.
+    std::uint64_t m_generations;
+
+    /// The generations advanced at once, more than one only when nothing
+    /// observes each generation and the engine's passes are deeper than one.
+    std::uint64_t m_batch;
+};
@@ -0,0 +1,105 @@
+#include "Histogram.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <iomanip>
+
+Histogram::Histogram(std::string name)
+    : m_name(std::move(name))
+    , m_buckets()
+{}
+
+void Histogram::record(std::chrono::nanoseconds duration)
+{
+    std::int64_t microseconds =
+        std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+
+    m_buckets[bucket(microseconds > 0 ? microseconds : 0)].fetch_add(1, std::memory_order_relaxed);
+}
+
+std::uint64_t Histogram::count() const
+{
+    std::uint64_t count = 0;
+
+    for (const std::atomic_uint64_t &bucket : m_buckets)
+        count += bucket.load(std::memory_order_relaxed);
+
+    return count;
+}
+
+std::chrono::microseconds Histogram::percentile(double percentile) const
+{
+    std::uint64_t total = count();
+    if (total == 0)
+        return std::chrono::microseconds(0);
+
+    // The rank of the duration at the percentile, counting from one.
+    std::uint64_t rank = std::max<std::uint64_t>(1, std::ceil(total * percentile / 100));
+
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < m_buckets.size(); i++) {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+
+        if (seen >= rank)
+            return std::chrono::microseconds(lower(i));
+    }
+
+    // Durations recorded while counting can leave the rank unreached.
+    return std::chrono::microseconds(lower(m_buckets.size() - 1));
+}
+
+void Histogram::dump(std::ostream &out) const
+{
+    std::uint64_t total = count();
+
+    out << m_name << ": " << total << " samples";
+
+    if (total == 0) {
+        out << "\n";
+        return;
+    }
+
+    out << ", p50 " << percentile(50).count() << "us"
+        << ", p90 " << percentile(90).count() << "us"
+        << ", p99 " << percentile(99).count() << "us"
+        << ", max " << percentile(100).count() << "us\n";
+
+    for (std::size_t i = 0; i < m_buckets.size(); i++) {
+        std::uint64_t n = m_buckets[i].load(std::memory_order_relaxed);
+        if (n == 0)
+            continue;
+
+        // A bar of up to 40 characters for the share of the samples.
+        std::size_t bar = (n * 40 + total - 1) / total;
+
+        out << std::setw(12) << lower(i) << "us "
+            << std::setw(8) << n << " "
+            << std::string(bar, '#') << "\n";
+    }
+}
+
+std::size_t Histogram::bucket(std::uint64_t microseconds)
+{
+    // The first buckets hold one microsecond each.
+    if (microseconds < s_steps)
+        return microseconds;
+
+    // Otherwise split the power of two by the bits after the leading one.
+    int exponent = std::bit_width(microseconds) - 1;
+    int shift = exponent - std::countr_zero<unsigned>(s_steps);
+
+    std::uint64_t step = (microseconds >> shift) - s_steps;
+    return (shift + 1) * s_steps + step;
+}
+
+std::uint64_t Histogram::lower(std::size_t bucket)
+{
+    if (bucket < s_steps)
+        return bucket;
+
+    int shift = bucket / s_steps - 1;
+    std::uint64_t step = bucket % s_steps;
+
+    return (s_steps + step) << shift;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/**
+ * @brief A histogram of durations in logarithmic buckets, recorded by one
+ * thread and read by any without locking.
+ * 
+ * Each power of two microseconds is split into eight buckets, so percentiles
+ * are accurate to within an eighth of their value from a microsecond to hours.
+ */
+class Histogram
+{
+public:
+
+    /**
+     * @brief Create an empty histogram.
+     * @param name The name printed when dumped.
+     */
+    Histogram(std::string name);
+
+    /**
+     * @brief Record one duration.
+     * @param duration The duration.
+     */
+    void record(std::chrono::nanoseconds duration);
+
+    /**
+     * @brief Get the number of recorded durations.
+     * @return The number of recorded durations.
+     */
+    std::uint64_t count() const;
+
+    /**
+     * @brief Get the duration at a percentile of those recorded, the lower
+     * bound of its bucket.
+     * 
+     * @param percentile The percentile from 0 to 100.
+     * @return The duration, or zero if none are recorded.
+     */
+    std::chrono::microseconds percentile(double percentile) const;
+
+    /**
+     * @brief Print the count, the p50, p90, p99 and maximum, and every
+     * non-empty bucket.
+     * 
+     * @param out The stream to print to.
+     */
+    void dump(std::ostream &out) const;
+
+private:
+
+    /// The number of buckets per power of two.
+    static constexpr int s_steps = 8;
+
+    /// The bucket of a number of microseconds.
+    static std::size_t bucket(std::uint64_t microseconds);
+
+    /// The smallest number of microseconds in a bucket.
+    static std::uint64_t lower(std::size_t bucket);
+
+    /// The name printed when dumped.
+    std::string m_name;
+
+    /// The number of durations in each bucket.
+    std::array<std::atomic_uint64_t, 64 * s_steps> m_buckets;
+};
@@ -0,0 +1,454 @@
+#include "HybridEngine.hpp"
+
+#include <algorithm>
+#include <bit>
+
+HybridEngine::HybridEngine(int width, int height)
+    : Engine(width, height)
+    , m_columns((width + s_chunk_size - 1) / s_chunk_size)
+    , m_rows((height + s_chunk_size - 1) / s_chunk_size)
+    , m_chunks()
+    , m_edges()
+    , m_created()
+    , m_keys()
+{}
+
+void HybridEngine::advance(std::vector<Tile> &born, std::vector<Tile> &died)
+{
+    // Gather every edge before stepping any chunk, since chunks are stepped in
+    // place.
+    m_edges.clear();
+
+    for (auto &[key, chunk] : m_chunks) {
+        m_edges.emplace(key, edges(key, chunk));
+    }
+
+    for (auto &[key, chunk] : m_chunks) {
+
+        step(key, chunk, born, died);
+
+        // Empty neighbors are stepped once from the edges around them. They
+        // are recorded as having empty edges so they are not stepped again.
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+
+                Tile neighbor(
+                    (key.x + dx + m_columns) % m_columns,
+                    (key.y + dy + m_rows) % m_rows
+                );
+
+                if (!m_edges.emplace(neighbor, Edges()).second)
+                    continue;
+
+                Chunk created;
+                step(neighbor, created, born, died);
+
+                if (created.population)
+                    m_created.emplace_back(neighbor, std::move(created));
+            }
+        }
+    }
+
+    std::erase_if(m_chunks, [](const auto &item) { return item.second.population == 0; });
+
+    for (auto &[key, chunk] : m_created) {
+        m_chunks.emplace(key, std::move(chunk));
+    }
+
+    m_created.clear();
+}
+
+void HybridEngine::update(int x, int y, bool alive)
+{
+    Tile key(x / s_chunk_size, y / s_chunk_size);
+    x %= s_chunk_size;
+    y %= s_chunk_size;
+
+    auto it = m_chunks.find(key);
+
+    if (it == m_chunks.end()) {
+        if (!alive)
+            return;
+
+        it = m_chunks.emplace(key, Chunk()).first;
+    }
+
+    Chunk &chunk = it->second;
+
+    if (chunk.rows) {
+        std::uint64_t &row = (*chunk.rows)[y];
+        std::uint64_t bit = std::uint64_t(1) << x;
+
+        if (bool(row & bit) != alive) {
+            row ^= bit;
+            chunk.population += alive ? 1 : -1;
+        }
+    }
+    else {
+        std::uint16_t cell = std::uint16_t(y * s_chunk_size + x);
+        auto position = std::lower_bound(chunk.cells.begin(), chunk.cells.end(), cell);
+        bool found = position != chunk.cells.end() && *position == cell;
+
+        if (alive && !found) {
+            chunk.cells.insert(position, cell);
+            chunk.population++;
+        }
+        else if (!alive && found) {
+            chunk.cells.erase(position);
+            chunk.population--;
+        }
+
+        // Keep inserting into a filling chunk cheap.
+        if (chunk.population > s_dense_population)
+            densify(chunk);
+    }
+
+    if (chunk.population == 0)
+        m_chunks.erase(it);
+}
+
+void HybridEngine::clear()
+{
+    m_chunks.clear();
+}
+
+std::size_t HybridEngine::memory() const
+{
+    // Each chunk is a node holding the key, the chunk and the next node, and
+    // each bucket is a pointer.
+    std::size_t bytes = m_chunks.bucket_count() * sizeof(void*);
+
+    for (auto &[key, chunk] : m_chunks) {
+        bytes += sizeof(Tile) + sizeof(Chunk) + sizeof(void*)
+               + chunk.cells.capacity() * sizeof(std::uint16_t)
+               + (chunk.rows ? sizeof(Rows) : 0);
+    }
+
+    return bytes;
+}
+
+std::size_t HybridEngine::dense_chunks() const
+{
+    return std::count_if(m_chunks.begin(), m_chunks.end(), [](const auto &item) {
+        return item.second.rows != nullptr;
+    });
+}
+
+std::size_t HybridEngine::sparse_chunks() const
+{
+    return m_chunks.size() - dense_chunks();
+}
+
+void HybridEngine::step(Tile key, Chunk &chunk, std::vector<Tile> &born, std::vector<Tile> &died)
+{
+    Halo halo = this->halo(key);
+
+    if (chunk.rows) {
+        step_dense(key, chunk, halo, born, died);
+
+        if (chunk.population < s_sparse_population)
+            sparsify(chunk);
+    }
+    else {
+        step_sparse(key, chunk, halo, born, died);
+
+        if (chunk.population > s_dense_population)
+            densify(chunk);
+    }
+}
+
+void HybridEngine::step_dense(Tile key, Chunk &chunk, const Halo &halo, std::vector<Tile> &born, std::vector<Tile> &died)
+{
+    int width = chunk_width(key.x);
+    int height = chunk_height(key.y);
+    std::uint64_t mask = width == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << width) - 1;
+    Rows &rows = *chunk.rows;
+
+    // A row from one above the chunk to one below, and the rows shifted so
+    // each bit holds the tile to its left or right.
+    struct Row {
+        std::uint64_t left;
+        std::uint64_t middle;
+        std::uint64_t right;
+    };
+
+    auto row = [&](int y) {
+        std::uint64_t middle;
+        bool left;
+        bool right;
+
+        if (y < 0) {
+            middle = halo.top;
+            left = halo.top_left;
+            right = halo.top_right;
+        }
+        else if (y >= height) {
+            middle = halo.bottom;
+            left = halo.bottom_left;
+            right = halo.bottom_right;
+        }
+        else {
+            middle = rows[y];
+            left = halo.left >> y & 1;
+            right = halo.right >> y & 1;
+        }
+
+        return Row {
+            (middle << 1 | left) & mask,
+            middle,
+            middle >> 1 | std::uint64_t(right) << (width - 1)
+        };
+    };
+
+    Row above = row(-1);
+    Row middle = row(0);
+    std::uint32_t population = 0;
+
+    for (int y = 0; y < height; y++) {
+
+        Row below = row(y + 1);
+
+        // Add the eight neighbors of every tile of the row at once, into four
+        // bit planes of the count.
+        std::uint64_t count[4] = {0, 0, 0, 0};
+        for (std::uint64_t neighbor : {
+            above.left, above.middle, above.right,
+            middle.left, middle.right,
+            below.left, below.middle, below.right
+        }) {
+            std::uint64_t carry = neighbor;
+            for (std::uint64_t &plane : count) {
+                std::uint64_t next = plane & carry;
+                plane ^= carry;
+                carry = next;
+            }
+        }
+
+        std::uint64_t next = 0;
+
+        for (int n = 0; n <= 8; n++) {
+            bool birth = m_rule.birth >> n & 1;
+            bool survival = m_rule.survival >> n & 1;
+            if (!birth && !survival)
+                continue;
+
+            std::uint64_t equal = mask;
+            for (int bit = 0; bit < 4; bit++)
+                equal &= n >> bit & 1 ? count[bit] : ~count[bit];
+
+            next |= equal & (birth && survival ? mask : birth ? ~middle.middle : middle.middle);
+        }
+
+        next &= mask;
+
+        for (std::uint64_t changed = next ^ middle.middle; changed; changed &= changed - 1) {
+            int x = std::countr_zero(changed);
+            Tile tile(key.x * s_chunk_size + x, key.y * s_chunk_size + y);
+            (next >> x & 1 ? born : died).push_back(tile);
+        }
+
+        rows[y] = next;
+        population += std::popcount(next);
+
+        above = middle;
+        middle = below;
+    }
+
+    chunk.population = population;
+}
+
+void HybridEngine::step_sparse(Tile key, Chunk &chunk, const Halo &halo, std::vector<Tile> &born, std::vector<Tile> &died)
+{
+    int width = chunk_width(key.x);
+    int height = chunk_height(key.y);
+
+    // Each alive tile adds one to the count of each neighbor inside the chunk,
+    // as the neighbor's cell shifted up by one. Alive tiles also add their own
+    // cell shifted up by one with the lowest bit set, marking it alive without
+    // counting, so sorting groups every count of a cell with its state.
+    m_keys.clear();
+
+    auto add = [&](int x, int y) {
+        if (x >= 0 && x < width && y >= 0 && y < height)
+            m_keys.push_back(std::uint32_t(y * s_chunk_size + x) << 1);
+    };
+
+    for (std::uint16_t cell : chunk.cells) {
+        int x = cell % s_chunk_size;
+        int y = cell / s_chunk_size;
+
+        m_keys.push_back(std::uint32_t(cell) << 1 | 1);
+
+        for (int dy = -1; dy <= 1; dy++)
+            for (int dx = -1; dx <= 1; dx++)
+                if (dx || dy)
+                    add(x + dx, y + dy);
+    }
+
+    for (std::uint64_t bits = halo.top; bits; bits &= bits - 1) {
+        int x = std::countr_zero(bits);
+        add(x - 1, 0); add(x, 0); add(x + 1, 0);
+    }
+
+    for (std::uint64_t bits = halo.bottom; bits; bits &= bits - 1) {
+        int x = std::countr_zero(bits);
+        add(x - 1, height - 1); add(x, height - 1); add(x + 1, height - 1);
+    }
+
+    for (std::uint64_t bits = halo.left; bits; bits &= bits - 1) {
+        int y = std::countr_zero(bits);
+        add(0, y - 1); add(0, y); add(0, y + 1);
+    }
+
+    for (std::uint64_t bits = halo.right; bits; bits &= bits - 1) {
+        int y = std::countr_zero(bits);
+        add(width - 1, y - 1); add(width - 1, y); add(width - 1, y + 1);
+    }
+
+    if (halo.top_left)
+        add(0, 0);
+    if (halo.top_right)
+        add(width - 1, 0);
+    if (halo.bottom_left)
+        add(0, height - 1);
+    if (halo.bottom_right)
+        add(width - 1, height - 1);
+
+    std::sort(m_keys.begin(), m_keys.end());
+
+    std::vector<std::uint16_t> cells;
+    cells.reserve(chunk.cells.size());
+
+    for (std::size_t i = 0; i < m_keys.size();) {
+
+        std::uint32_t cell = m_keys[i] >> 1;
+        int n = 0;
+        bool alive = false;
+
+        for (; i < m_keys.size() && m_keys[i] >> 1 == cell; i++) {
+            if (m_keys[i] & 1)
+                alive = true;
+            else
+                n++;
+        }
+
+        bool next = (alive ? m_rule.survival : m_rule.birth) >> n & 1;
+
+        if (next)
+            cells.push_back(std::uint16_t(cell));
+
+        if (next != alive) {
+            Tile tile(
+                key.x * s_chunk_size + int(cell % s_chunk_size),
+                key.y * s_chunk_size + int(cell / s_chunk_size)
+            );
+            (next ? born : died).push_back(tile);
+        }
+    }
+
+    chunk.cells = std::move(cells);
+    chunk.population = std::uint32_t(chunk.cells.size());
+}
+
+void HybridEngine::densify(Chunk &chunk)
+{
+    chunk.rows = std::make_unique<Rows>();
+    chunk.rows->fill(0);
+
+    for (std::uint16_t cell : chunk.cells)
+        (*chunk.rows)[cell / s_chunk_size] |= std::uint64_t(1) << cell % s_chunk_size;
+
+    chunk.cells.clear();
+    chunk.cells.shrink_to_fit();
+}
+
+void HybridEngine::sparsify(Chunk &chunk)
+{
+    chunk.cells.clear();
+    chunk.cells.reserve(chunk.population);
+
+    for (int y = 0; y < s_chunk_size; y++)
+        for (std::uint64_t bits = (*chunk.rows)[y]; bits; bits &= bits - 1)
+            chunk.cells.push_back(std::uint16_t(y * s_chunk_size + std::countr_zero(bits)));
+
+    chunk.rows.reset();
+}
+
+HybridEngine::Edges HybridEngine::edges(Tile key, const Chunk &chunk) const
+{
+    int width = chunk_width(key.x);
+    int height = chunk_height(key.y);
+    Edges edges;
+
+    auto add = [&](int x, int y) {
+        if (y == 0)
+            edges.top |= std::uint64_t(1) << x;
+        if (y == height - 1)
+            edges.bottom |= std::uint64_t(1) << x;
+        if (x == 0)
+            edges.left |= std::uint64_t(1) << y;
+        if (x == width - 1)
+            edges.right |= std::uint64_t(1) << y;
+    };
+
+    if (chunk.rows) {
+        const Rows &rows = *chunk.rows;
+        edges.top = rows[0];
+        edges.bottom = rows[height - 1];
+
+        for (int y = 0; y < height; y++) {
+            edges.left |= (rows[y] & 1) << y;
+            edges.right |= (rows[y] >> (width - 1) & 1) << y;
+        }
+    }
+    else {
+        for (std::uint16_t cell : chunk.cells)
+            add(cell % s_chunk_size, cell / s_chunk_size);
+    }
+
+    return edges;
+}
+
+HybridEngine::Halo HybridEngine::halo(Tile key) const
+{
+    const Edges &north = edges_of(key.x, key.y - 1);
+    const Edges &south = edges_of(key.x, key.y + 1);
+    const Edges &west = edges_of(key.x - 1, key.y);
+    const Edges &east = edges_of(key.x + 1, key.y);
+    const Edges &north_west = edges_of(key.x - 1, key.y - 1);
+    const Edges &north_east = edges_of(key.x + 1, key.y - 1);
+    const Edges &south_west = edges_of(key.x - 1, key.y + 1);
+    const Edges &south_east = edges_of(key.x + 1, key.y + 1);
+
+    // The chunks left of this one may be narrower when it is the first column.
+    int west_width = chunk_width((key.x - 1 + m_columns) % m_columns);
+
+    return Halo {
+        north.bottom,
+        south.top,
+        west.right,
+        east.left,
+        bool(north_west.bottom >> (west_width - 1) & 1),
+        bool(north_east.bottom & 1),
+        bool(south_west.top >> (west_width - 1) & 1),
+        bool(south_east.top & 1)
+    };
+}
+
+const HybridEngine::Edges &HybridEngine::edges_of(int x, int y) const
+{
+    static const Edges s_empty;
+
+    auto it = m_edges.find(Tile((x + m_columns) % m_columns, (y + m_rows) % m_rows));
+    return it == m_edges.end() ? s_empty : it->second;
+}
+
+int HybridEngine::chunk_width(int x) const
+{
+    return std::min(s_chunk_size, m_width - x * s_chunk_size);
+}
+
+int HybridEngine::chunk_height(int y) const
+{
+    return std::min(s_chunk_size, m_height - y * s_chunk_size);
+}
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "Engine.hpp"
+
+/**
+ * @brief An engine dividing the game space into chunks that each store their
+ * tiles either as a sorted list or as a bit per tile, whichever suits their
+ * population.
+ * 
+ * Sparse chunks are stepped by counting the neighbors of their alive tiles,
+ * so their cost follows the number of alive tiles. Dense chunks are stepped a
+ * row of 64 tiles at a time with bitwise adders, so their cost is fixed. Empty
+ * chunks are not stored, and are only stepped when a neighbor has alive tiles
+ * on the edge they share.
+ * 
+ * After each step a chunk becomes dense when its population rises above one
+ * threshold, and sparse when it falls below a lower one, so chunks near a
+ * threshold do not convert back and forth every generation.
+ * 
+ * Chunks only exchange the tiles on their edges, which are gathered for every
+ * chunk before any chunk is stepped.
+ */
+class HybridEngine : public Engine
+{
+public:
+
+    /**
+     * @brief Create an engine with an empty game space.
+     * 
+     * @param width The width of the grid in tiles.
+     * @param height The height of the grid in tiles.
+     */
+    HybridEngine(int width, int height);
+
+    void advance(std::vector<Tile> &born, std::vector<Tile> &died) override;
+    void update(int x, int y, bool alive) override;
+    void clear() override;
+
+    std::string name() const override {
+        return "hybrid";
+    }
+
+    std::size_t memory() const override;
+
+    /**
+     * @brief Get the number of chunks storing a bit per tile.
+     * @return The number of dense chunks.
+     */
+    std::size_t dense_chunks() const;
+
+    /**
+     * @brief Get the number of chunks storing a list of alive tiles.
+     * @return The number of sparse chunks.
+     */
+    std::size_t sparse_chunks() const;
+
+private:
+
+    /// The width and height of a chunk in tiles, one row per 64 bit word.
+    static constexpr int s_chunk_size = 64;
+
+    /// The population above which a sparse chunk becomes dense. A dense chunk
+    /// steps in about the time a sparse chunk with this many tiles does.
+    static constexpr std::uint32_t s_dense_population = 192;
+
+    /// The population below which a dense chunk becomes sparse.
+    static constexpr std::uint32_t s_sparse_population = 64;
+
+    /// Type of the rows of a dense chunk, where bit x of row y is the tile at
+    /// x, y of the chunk.
+    using Rows = std::array<std::uint64_t, s_chunk_size>;
+
+    /// A chunk with at least one alive tile.
+    struct Chunk {
+
+        /// The number of alive tiles.
+        std::uint32_t population = 0;
+
+        /// The alive tiles of a sparse chunk as y * 64 + x, in ascending order.
+        std::vector<std::uint16_t> cells;
+
+        /// The rows of a dense chunk, or null if the chunk is sparse.
+        std::unique_ptr<Rows> rows;
+    };
+
+    /// The tiles on the edges of a chunk. Bit x of the top and bottom rows is
+    /// column x, and bit y of the left and right columns is row y.
+    struct Edges {
+        std::uint64_t top = 0;
+        std::uint64_t bottom = 0;
+        std::uint64_t left = 0;
+        std::uint64_t right = 0;
+    };
+
+    /// The tiles just outside a chunk, from the edges of its neighbors.
+    struct Halo {
+        std::uint64_t top;
+        std::uint64_t bottom;
+        std::uint64_t left;
+        std::uint64_t right;
+        bool top_left;
+        bool top_right;
+        bool bottom_left;
+        bool bottom_right;
+    };
+
+    /**
+     * @brief Advance a chunk by one generation.
+     * 
+     * @param key The position of the chunk in chunks.
+     * @param chunk The chunk, empty if it is not stored.
+     * @param born Appended with each tile that became alive.
+     * @param died Appended with each tile that died.
+     */
+    void step(Tile key, Chunk &chunk, std::vector<Tile> &born, std::vector<Tile> &died);
+
+    /**
+     * @brief Advance a dense chunk by one generation.
+     */
+    void step_dense(Tile key, Chunk &chunk, const Halo &halo, std::vector<Tile> &born, std::vector<Tile> &died);
+
+    /**
+     * @brief Advance a sparse chunk by one generation.
+     */
+    void step_sparse(Tile key, Chunk &chunk, const Halo &halo, std::vector<Tile> &born, std::vector<Tile> &died);
+
+    /**
+     * @brief Store a chunk's tiles as a bit per tile.
+     * @param chunk The sparse chunk.
+     */
+    static void densify(Chunk &chunk);
+
+    /**
+     * @brief Store a chunk's tiles as a list of alive tiles.
+     * @param chunk The dense chunk.
+     */
+    static void sparsify(Chunk &chunk);
+
+    /**
+     * @brief Gather the tiles on the edges of a chunk.
+     * 
+     * @param key The position of the chunk in chunks.
+     * @param chunk The chunk.
+     * @return The tiles on its edges.
+     */
+    Edges edges(Tile key, const Chunk &chunk) const;
+
+    /**
+     * @brief Gather the tiles just outside a chunk.
+     * 
+     * @param key The position of the chunk in chunks.
+     * @return The tiles just outside it.
+     */
+    Halo halo(Tile key) const;
+
+    /**
+     * @brief Get the edges of a chunk gathered at the start of the step.
+     * 
+     * @param x The x position of the chunk in chunks, wrapped if one out.
+     * @param y The y position of the chunk in chunks, wrapped if one out.
+     * @return The edges, or no tiles if the chunk is empty.
+     */
+    const Edges &edges_of(int x, int y) const;
+
+    /**
+     * @brief Get the width of the chunks of a column, smaller on the right
+     * edge of a game space whose width is not a multiple of the chunk size.
+     * 
+     * @param x The x position of the chunk in chunks.
+     * @return The width in tiles.
+     */
+    int chunk_width(int x) const;
+
+    /**
+     * @brief Get the height of the chunks of a row.
+     * 
+     * @param y The y position of the chunk in chunks.
+     * @return The height in tiles.
+     */
+    int chunk_height(int y) const;
+
+    /// The number of columns of chunks.
+    int m_columns;
+
+    /// The number of rows of chunks.
+    int m_rows;
+
+    /// The chunks with at least one alive tile, by position in chunks.
+    std::unordered_map<Tile, Chunk> m_chunks;
+
+    /// The edges of each chunk stepped this generation.
+    std::unordered_map<Tile, Edges> m_edges;
+
+    /// Chunks that became alive this generation, added after stepping.
+    std::vector<std::pair<Tile, Chunk>> m_created;
+
+    /// The neighbor counts of a sparse chunk being stepped.
+    std::vector<std::uint32_t> m_keys;
+};
@@ -0,0 +1,180 @@
+#include "Journal.hpp"
+
+#include <iomanip>
+#include <sstream>
+
+Journal::Journal(const std::string &path, int width, int height, double target)
+    : m_file(path)
+    , m_mutex()
+    , m_condition()
+    , m_buffer()
+    , m_failed(false)
+    , m_thread()
+{
+    // Write targets exactly, so a replay compares them with the same values.
+    m_file << std::setprecision(17);
+    m_file << "journal " << width << " " << height << " " << target << "\n";
+
+    m_failed = !m_file;
+
+    m_thread = std::jthread([this](std::stop_token stop) { writer_thread(stop); });
+}
+
+Journal::~Journal()
+{
+    m_thread.request_stop();
+    m_thread.join();
+}
+
+void Journal::record(const JournalEntry &entry)
+{
+    {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        m_buffer.push_back(entry);
+    }
+
+    m_condition.notify_one();
+}
+
+bool Journal::good()
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    return !m_failed;
+}
+
+bool Journal::read(const std::string &path, int &width, int &height, double &target, std::vector<JournalEntry> &entries)
+{
+    std::ifstream file(path);
+
+    std::string header;
+    std::string value;
+    if (!(file >> header >> width >> height >> value) || header != "journal" || width < 3 || height < 3)
+        return false;
+
+    entries.clear();
+
+    try {
+        // The target may be inf, which only std::stod reads.
+        target = std::stod(value);
+
+        std::string line;
+        std::getline(file, line);
+
+        while (std::getline(file, line)) {
+
+            if (line.empty())
+                continue;
+
+            std::istringstream stream(line);
+            JournalEntry entry {};
+            std::string action;
+
+            if (!(stream >> entry.generation >> action))
+                return false;
+
+            if (action == "place" || action == "remove") {
+                entry.type = action == "place" ? JournalEntry::Type::PLACE : JournalEntry::Type::REMOVE;
+                if (!(stream >> entry.x >> entry.y))
+                    return false;
+            }
+            else if (action == "clear") {
+                entry.type = JournalEntry::Type::CLEAR;
+            }
+            else if (action == "pause") {
+                entry.type = JournalEntry::Type::PAUSE;
+            }
+            else if (action == "resume") {
+                entry.type = JournalEntry::Type::RESUME;
+            }
+            else if (action == "speed" && stream >> value) {
+                entry.type = JournalEntry::Type::SPEED;
+                entry.target = std::stod(value);
+            }
+            else if (action == "end" && stream >> entry.fingerprint) {
+                entry.type = JournalEntry::Type::END;
+            }
+            else {
+                return false;
+            }
+
+            // Actions are recorded in the order they are applied.
+            if (!entries.empty() && entry.generation < entries.back().generation)
+                return false;
+
+            entries.push_back(entry);
+        }
+    }
+    catch (const std::logic_error &) {
+        // Targets that do not parse, from std::stod.
+        return false;
+    }
+
+    return true;
+}
+
+std::uint64_t Journal::fingerprint(GameOfLife &model)
+{
+    // Sum a hash of every tile, so the order the engine visits them in does
+    // not matter.
+    std::uint64_t fingerprint = 0;
+
+    model.for_each_alive_in(Region(0, 0, model.width(), model.height()), [&](Tile tile) {
+        std::uint64_t hash = (std::uint64_t(std::uint32_t(tile.x)) << 32) | std::uint32_t(tile.y);
+
+        // The splitmix64 finaliser.
+        hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+        hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
+        hash = hash ^ (hash >> 31);
+
+        fingerprint += hash;
+    });
+
+    return fingerprint;
+}
+
+void Journal::writer_thread(std::stop_token stop)
+{
+    // The entries taken from the buffer, written without the mutex.
+    std::vector<JournalEntry> writing;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    for (;;) {
+
+        m_condition.wait(lock, stop, [&]{ return !m_buffer.empty(); });
+
+        // Write everything recorded before stopping.
+        if (m_buffer.empty())
+            break;
+
+        std::swap(writing, m_buffer);
+        lock.unlock();
+
+        for (const JournalEntry &entry : writing) {
+
+            m_file << entry.generation << " ";
+
+            switch (entry.type) {
+            case JournalEntry::Type::PLACE  : m_file << "place " << entry.x << " " << entry.y; break;
+            case JournalEntry::Type::REMOVE : m_file << "remove " << entry.x << " " << entry.y; break;
+            case JournalEntry::Type::CLEAR  : m_file << "clear"; break;
+            case JournalEntry::Type::PAUSE  : m_file << "pause"; break;
+            case JournalEntry::Type::RESUME : m_file << "resume"; break;
+            case JournalEntry::Type::SPEED  : m_file << "speed " << entry.target; break;
+            case JournalEntry::Type::END    : m_file << "end " << entry.fingerprint; break;
+            }
+
+            m_file << "\n";
+        }
+
+        // Flush each batch, so a crash loses at most the entries being
+        // written.
+        m_file.flush();
+        bool failed = !m_file;
+
+        writing.clear();
+        lock.lock();
+
+        m_failed = m_failed || failed;
+    }
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "GameOfLife.hpp"
+
+/**
+ * @brief An action that changed a model, stamped with the generation it was
+ * applied before.
+ */
+struct JournalEntry {
+
+    /// The kinds of action.
+    enum class Type {
+        PLACE,
+        REMOVE,
+        CLEAR,
+        PAUSE,
+        RESUME,
+        SPEED,
+        END
+    };
+
+    /// The generation the action was applied before.
+    std::uint64_t generation;
+
+    /// The kind of action.
+    Type type;
+
+    /// The tile placed or removed.
+    int x = 0;
+    int y = 0;
+
+    /// The new target generations per second of a speed change.
+    double target = 0;
+
+    /// The fingerprint of the model at the end.
+    std::uint64_t fingerprint = 0;
+};
+
+/**
+ * @brief Journals the actions changing a model to a file, so the same
+ * sequence can be replayed headless.
+ * 
+ * Recording only appends to a buffer, and a background thread writes the
+ * buffered entries, so the thread handling input never waits for the disk.
+ * 
+ * The journal is text. The first line is the header "journal WIDTH HEIGHT
+ * TARGET", then each line is the generation followed by one of:
+ * - place X Y
+ * - remove X Y
+ * - clear
+ * - pause
+ * - resume
+ * - speed TARGET        Where TARGET is generations per second, or inf.
+ * - end FINGERPRINT     The fingerprint of the model when journaling ended.
+ */
+class Journal
+{
+public:
+
+    /**
+     * @brief Start journaling a model to a file, replacing it.
+     * 
+     * @param path The path of the journal.
+     * @param width The width of the model.
+     * @param height The height of the model.
+     * @param target The target generations per second at the start.
+     */
+    Journal(const std::string &path, int width, int height, double target);
+
+    /**
+     * @brief Write every recorded entry and close the file.
+     */
+    ~Journal();
+
+    /**
+     * @brief Append an entry, written by the background thread.
+     * @param entry The entry.
+     */
+    void record(const JournalEntry &entry);
+
+    /**
+     * @brief If the file could be opened and no entry failed to write.
+     * @return If journaling succeeded so far.
+     */
+    bool good();
+
+    /**
+     * @brief Read a journal.
+     * 
+     * @param path The path of the journal.
+     * @param width Assigned the width of the model.
+     * @param height Assigned the height of the model.
+     * @param target Assigned the target generations per second at the start.
+     * @param entries Assigned the entries in the order they were recorded.
+     * @return If the journal was read, otherwise it is missing or malformed.
+     */
+    static bool read(const std::string &path, int &width, int &height, double &target, std::vector<JournalEntry> &entries);
+
+    /**
+     * @brief Get a fingerprint of the alive tiles of a model, equal for equal
+     * models whatever their engine.
+     * 
+     * @param model The model.
+     * @return The fingerprint.
+     */
+    static std::uint64_t fingerprint(GameOfLife &model);
+
+private:
+
+    /**
+     * @brief Joinable thread writing the buffered entries.
+     * @param stop The stop signal, after which the remaining entries are
+     * written.
+     */
+    void writer_thread(std::stop_token stop);
+
+    /// The journal file, only used by the writer thread after the header.
+    std::ofstream m_file;
+
+    /// Mutex protecting the buffer and the failure state.
+    std::mutex m_mutex;
+
+    /// Notified when an entry is buffered.
+    std::condition_variable_any m_condition;
+
+    /// The entries recorded but not yet taken by the writer thread.
+    std::vector<JournalEntry> m_buffer;
+
+    /// If the file could not be written.
+    bool m_failed;
+
+    /// The writer thread, stopped before anything it uses is destroyed.
+    std::jthread m_thread;
+};
@@ -0,0 +1,266 @@
+#include "LargerThanLifeEngine.hpp"
+
+#include <algorithm>
+#include <latch>
+
+LargerThanLifeEngine::LargerThanLifeEngine(int width, int height, const LtlRule &rule, std::size_t workers)
+    : Engine(width, height)
+    , m_ltl_rule(rule)
+    , m_current(std::size_t(width) * height, 0)
+    , m_next(std::size_t(width) * height, 0)
+    , m_bands()
+    , m_pool()
+{
+    int bands = std::clamp<int>(workers, 1, height);
+
+    // Split the rows evenly.
+    for (int i = 0; i < bands; i++) {
+        Band band {};
+        band.top = i * height / bands;
+        band.bottom = (i + 1) * height / bands;
+        m_bands.push_back(std::move(band));
+    }
+
+    if (bands > 1)
+        m_pool = std::make_unique<ThreadPool>(bands - 1);
+}
+
+void LargerThanLifeEngine::advance(std::vector<Tile> &born, std::vector<Tile> &died)
+{
+    if (m_pool) {
+        std::latch done(m_bands.size() - 1);
+
+        for (std::size_t i = 1; i < m_bands.size(); i++) {
+            m_pool->submit([this, i, &done] {
+                step(m_bands[i]);
+                done.count_down();
+            });
+        }
+
+        step(m_bands[0]);
+        done.wait();
+    }
+    else {
+        step(m_bands[0]);
+    }
+
+    // Report the changes in row order, whatever order the bands finished in.
+    for (Band &band : m_bands) {
+        born.insert(born.end(), band.born.begin(), band.born.end());
+        died.insert(died.end(), band.died.begin(), band.died.end());
+    }
+
+    m_current.swap(m_next);
+}
+
+void LargerThanLifeEngine::update(int x, int y, bool alive)
+{
+    m_current[std::size_t(y) * m_width + x] = alive;
+}
+
+void LargerThanLifeEngine::clear()
+{
+    std::fill(m_current.begin(), m_current.end(), 0);
+}
+
+std::size_t LargerThanLifeEngine::memory() const
+{
+    std::size_t memory = m_current.capacity() + m_next.capacity();
+
+    for (const Band &band : m_bands) {
+        memory += sizeof(std::uint32_t) * (
+            band.extended.capacity() + band.ring.capacity()
+            + band.diagonal.capacity() + band.counts.capacity()
+        );
+    }
+
+    return memory;
+}
+
+void LargerThanLifeEngine::step(Band &band)
+{
+    band.born.clear();
+    band.died.clear();
+
+    if (m_ltl_rule.von_neumann)
+        count_von_neumann(band);
+    else
+        count_moore(band);
+}
+
+void LargerThanLifeEngine::count_moore(Band &band)
+{
+    int r = m_ltl_rule.radius;
+    int span = 2 * r + 1;
+
+    band.ring.resize(std::size_t(span) * m_width);
+    band.counts.assign(m_width, 0);
+
+    // Slide a window of the span along a row, replacing a row of the ring
+    // with the sum of the span of tiles around each tile.
+    auto horizontal = [&](int y, std::uint32_t *sums) {
+        extend(band, y, r);
+        const std::uint32_t *tiles = band.extended.data();
+
+        std::uint32_t sum = 0;
+        for (int i = 0; i < span; i++)
+            sum += tiles[i];
+
+        sums[0] = sum;
+        for (int x = 1; x < m_width; x++) {
+            sum += tiles[x + 2 * r] - tiles[x - 1];
+            sums[x] = sum;
+        }
+    };
+
+    // The ring holds the rows within the radius of the row being counted, and
+    // the counts are their column sums.
+    for (int i = 0; i < span; i++) {
+        std::uint32_t *sums = &band.ring[std::size_t(i) * m_width];
+        horizontal(band.top - r + i, sums);
+
+        for (int x = 0; x < m_width; x++)
+            band.counts[x] += sums[x];
+    }
+
+    for (int y = band.top; y < band.bottom; y++) {
+
+        apply(band, y);
+
+        if (y + 1 == band.bottom)
+            break;
+
+        // Slide down a row, replacing the row leaving the span with the row
+        // entering it.
+        std::uint32_t *sums = &band.ring[std::size_t((y - band.top) % span) * m_width];
+
+        for (int x = 0; x < m_width; x++)
+            band.counts[x] -= sums[x];
+
+        horizontal(y + r + 1, sums);
+
+        for (int x = 0; x < m_width; x++)
+            band.counts[x] += sums[x];
+    }
+}
+
+void LargerThanLifeEngine::count_von_neumann(Band &band)
+{
+    // Row t of the diamond around a tile spans r - |t| tiles either side, so
+    // its count is a difference of row prefix sums at each end. Down the
+    // diamond those ends step one column at a time, so each quarter of the
+    // boundary is a difference of two running sums of the prefix sums along a
+    // diagonal, d1 down and to the right, d2 down and to the left.
+    int r = m_ltl_rule.radius;
+    int rows = 2 * r + 2;
+    int columns = m_width + 2 * (r + 1);
+
+    band.ring.resize(std::size_t(rows) * columns);
+    band.diagonal.resize(std::size_t(rows) * columns);
+    band.counts.resize(m_width);
+
+    // Sum row t of the band, counting from r + 1 rows above it, into the
+    // rings. Both diagonals start over from zero at the first row, which is
+    // above every row the diamonds of the band reach.
+    auto diagonals = [&](int t) {
+        extend(band, band.top - r - 1 + t, r + 1);
+
+        std::uint32_t *prefix = band.extended.data();
+        for (int j = 1; j < columns; j++)
+            prefix[j] += prefix[j - 1];
+
+        std::uint32_t *d1 = &band.ring[std::size_t(t % rows) * columns];
+        std::uint32_t *d2 = &band.diagonal[std::size_t(t % rows) * columns];
+
+        if (t == 0) {
+            std::copy(prefix, prefix + columns, d1);
+            std::copy(prefix, prefix + columns, d2);
+            return;
+        }
+
+        const std::uint32_t *above1 = &band.ring[std::size_t((t - 1) % rows) * columns];
+        const std::uint32_t *above2 = &band.diagonal[std::size_t((t - 1) % rows) * columns];
+
+        d1[0] = prefix[0];
+        for (int j = 1; j < columns; j++)
+            d1[j] = prefix[j] + above1[j - 1];
+
+        for (int j = 0; j < columns - 1; j++)
+            d2[j] = prefix[j] + above2[j + 1];
+        d2[columns - 1] = prefix[columns - 1];
+    };
+
+    for (int t = 0; t < rows; t++)
+        diagonals(t);
+
+    for (int y = band.top; y < band.bottom; y++) {
+
+        // The row of the band in the rings, and the rows at the top and bottom
+        // of its diamonds.
+        int t = y - band.top + r + 1;
+
+        const std::uint32_t *d1 = &band.ring[std::size_t(t % rows) * columns];
+        const std::uint32_t *d1_top = &band.ring[std::size_t((t - r - 1) % rows) * columns];
+        const std::uint32_t *d1_bottom = &band.ring[std::size_t((t + r) % rows) * columns];
+        const std::uint32_t *d2 = &band.diagonal[std::size_t(t % rows) * columns];
+        const std::uint32_t *d2_top = &band.diagonal[std::size_t((t - r - 1) % rows) * columns];
+        const std::uint32_t *d2_bottom = &band.diagonal[std::size_t((t + r) % rows) * columns];
+
+        for (int x = 0; x < m_width; x++) {
+            int c = x + r + 1;
+
+            // The right ends of the upper and lower halves, less the left ends
+            // before the upper and lower halves. Differences wrap like the
+            // sums, so the count is exact.
+            std::uint32_t right = (d1[c + r] - d1_top[c - 1]) + (d2_bottom[c] - d2[c + r]);
+            std::uint32_t left = (d2[c - r - 1] - d2_top[c]) + (d1_bottom[c - 1] - d1[c - r - 1]);
+
+            band.counts[x] = right - left;
+        }
+
+        apply(band, y);
+
+        // Replace the top row of the diamonds with the row below them.
+        if (y + 1 < band.bottom)
+            diagonals(t + r + 1);
+    }
+}
+
+void LargerThanLifeEngine::apply(Band &band, int y)
+{
+    const std::uint8_t *current = &m_current[std::size_t(y) * m_width];
+    std::uint8_t *next = &m_next[std::size_t(y) * m_width];
+
+    for (int x = 0; x < m_width; x++) {
+        bool alive = current[x];
+        int count = band.counts[x] - (m_ltl_rule.middle ? 0 : alive);
+
+        bool live = alive
+            ? count >= m_ltl_rule.survival_minimum && count <= m_ltl_rule.survival_maximum
+            : count >= m_ltl_rule.birth_minimum && count <= m_ltl_rule.birth_maximum;
+
+        next[x] = live;
+
+        if (live != alive)
+            (live ? band.born : band.died).push_back(Tile {x, y});
+    }
+}
+
+void LargerThanLifeEngine::extend(Band &band, int y, int margin)
+{
+    y = ((y % m_height) + m_height) % m_height;
+    const std::uint8_t *row = &m_current[std::size_t(y) * m_width];
+
+    band.extended.resize(m_width + 2 * margin);
+    std::uint32_t *extended = band.extended.data();
+
+    // The margin is never wider than the row, so wraps once.
+    for (int j = 0; j < margin; j++)
+        extended[j] = row[m_width - margin + j];
+
+    for (int x = 0; x < m_width; x++)
+        extended[margin + x] = row[x];
+
+    for (int j = 0; j < margin; j++)
+        extended[margin + m_width + j] = row[j];
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Engine.hpp"
+#include "ThreadPool.hpp"
+
+/**
+ * @brief An engine stepping a Larger than Life rule, whose neighborhood is
+ * every tile within a radius, on a game space that wraps at its edges.
+ * 
+ * Counting each neighborhood directly costs the square of the radius per tile.
+ * Instead the Moore square is counted with running sums, sliding a window
+ * along each row and then down each column, and the von Neumann diamond with
+ * running sums of row prefix sums along both diagonals. Either way a tile
+ * costs the same few additions at any radius.
+ * 
+ * The game space is split into bands of rows stepped in parallel. Each band
+ * reads the rows within the radius above and below it, wrapping around the
+ * game space, and keeps only as many rows of sums as the neighborhood is
+ * tall.
+ */
+class LargerThanLifeEngine : public Engine
+{
+public:
+
+    /**
+     * @brief Create an engine with an empty game space.
+     * 
+     * @param width The width of the grid in tiles, at least the neighborhood.
+     * @param height The height of the grid in tiles, at least the
+     * neighborhood.
+     * @param rule The rule.
+     * @param workers The number of bands stepped in parallel.
+     */
+    LargerThanLifeEngine(int width, int height, const LtlRule &rule, std::size_t workers);
+
+    void advance(std::vector<Tile> &born, std::vector<Tile> &died) override;
+    void update(int x, int y, bool alive) override;
+    void clear() override;
+
+    std::string name() const override {
+        return "ltl";
+    }
+
+    std::size_t memory() const override;
+
+    /**
+     * @brief Get the Larger than Life rule the engine advances by, in place
+     * of the life-like rule.
+     * @return The rule.
+     */
+    inline const LtlRule &ltl_rule() const {
+        return m_ltl_rule;
+    }
+
+private:
+
+    /// A band of rows stepped by one worker.
+    struct Band {
+
+        /// The first row of the band.
+        int top;
+
+        /// The row after the last row of the band.
+        int bottom;
+
+        /// The tiles that became alive and died in the band.
+        std::vector<Tile> born;
+        std::vector<Tile> died;
+
+        /// A row of the game space extended by the radius on each side.
+        std::vector<std::uint32_t> extended;
+
+        /// The rows of sums the neighborhood spans, used as a ring.
+        std::vector<std::uint32_t> ring;
+
+        /// The second ring of diagonal sums of the von Neumann diamond.
+        std::vector<std::uint32_t> diagonal;
+
+        /// The count of each tile of the row being stepped.
+        std::vector<std::uint32_t> counts;
+    };
+
+    /**
+     * @brief Step a band, writing the next generation of its rows.
+     * @param band The band.
+     */
+    void step(Band &band);
+
+    /**
+     * @brief Count the Moore square of each tile of a band, stepping each row
+     * once counted.
+     * @param band The band.
+     */
+    void count_moore(Band &band);
+
+    /**
+     * @brief Count the von Neumann diamond of each tile of a band, stepping
+     * each row once counted.
+     * @param band The band.
+     */
+    void count_von_neumann(Band &band);
+
+    /**
+     * @brief Write the next generation of a row from its counts.
+     * 
+     * @param band The band of the row.
+     * @param y The row.
+     */
+    void apply(Band &band, int y);
+
+    /**
+     * @brief Copy a row, wrapping vertically, into a band's extended row,
+     * wrapping horizontally by a margin on each side.
+     * 
+     * @param band The band.
+     * @param y The row, which may be outside the game space.
+     * @param margin The tiles added to each side.
+     */
+    void extend(Band &band, int y, int margin);
+
+    /// The rule advanced by.
+    LtlRule m_ltl_rule;
+
+    /// The tiles of the current generation, one byte each, row major.
+    std::vector<std::uint8_t> m_current;
+
+    /// The tiles of the next generation.
+    std::vector<std::uint8_t> m_next;
+
+    /// The bands of rows.
+    std::vector<Band> m_bands;
+
+    /// Workers stepping every band but the first, which the calling thread
+    /// steps, or null with one band.
+    std::unique_ptr<ThreadPool> m_pool;
+};
@@ -0,0 +1,164 @@
+#include "LutEngine.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace {
+
+/**
+ * @brief Build the table of a rule.
+ * 
+ * Bit y * 4 + x of an index is the tile at x, y of a 4x4 block, and bit
+ * y * 2 + x of a result is the tile at x + 1, y + 1 of the block.
+ * 
+ * @param rule The rule.
+ * @return The table.
+ */
+constexpr LutEngine::Table make_table(Rule rule)
+{
+    // The next state of the centre of each 3x3 block, indexed with the same
+    // row stride of four as the 4x4 blocks. Building the full table from this
+    // keeps it within the compiler's constant evaluation limits.
+    std::array<std::uint8_t, 0x800> tiles {};
+
+    for (unsigned index = 0; index < tiles.size(); index++) {
+        bool alive = index >> 5 & 1;
+        int n = std::popcount(index & 0x777u) - alive;
+        tiles[index] = (alive ? rule.survival : rule.birth) >> n & 1;
+    }
+
+    LutEngine::Table table {};
+
+    for (unsigned index = 0; index < table.size(); index++) {
+        table[index] = tiles[index & 0x777]
+                     | tiles[index >> 1 & 0x777] << 1
+                     | tiles[index >> 4 & 0x777] << 2
+                     | tiles[index >> 5 & 0x777] << 3;
+    }
+
+    return table;
+}
+
+/// The table of Conway's rule, built at compile time.
+constexpr LutEngine::Table s_conway_table = make_table(s_conway);
+
+/// Spread the bits of a block to the top left 2x2 tiles of a 4x4 index.
+constexpr unsigned spread(unsigned block)
+{
+    return (block & 3) | (block & 12) << 2;
+}
+
+/// Gather the 4x4 index of four blocks, from the top left going clockwise.
+inline unsigned gather(unsigned a, unsigned b, unsigned d, unsigned c)
+{
+    return spread(a) | spread(b) << 2 | spread(c) << 8 | spread(d) << 10;
+}
+
+/// The centre 2x2 tiles of a 4x4 index, in the bits of a block.
+inline unsigned centre(unsigned index)
+{
+    return (index >> 5 & 3) | (index >> 7 & 12);
+}
+
+}
+
+LutEngine::LutEngine(int width, int height)
+    : Engine(width, height)
+    , m_columns(width / 2)
+    , m_rows(height / 2)
+    , m_current(std::size_t(m_columns) * m_rows, 0)
+    , m_next(std::size_t(m_columns) * m_rows, 0)
+    , m_offset(false)
+    , m_table(&s_conway_table)
+    , m_custom()
+    , m_custom_rule(s_conway)
+{}
+
+void LutEngine::advance(std::vector<Tile> &born, std::vector<Tile> &died)
+{
+    if (m_rule == s_conway) {
+        m_table = &s_conway_table;
+    }
+    else if (!m_custom || !(m_custom_rule == m_rule)) {
+        m_custom = std::make_unique<Table>(make_table(m_rule));
+        m_custom_rule = m_rule;
+        m_table = m_custom.get();
+    }
+    else {
+        m_table = m_custom.get();
+    }
+
+    const Table &table = *m_table;
+
+    // Aligned blocks gather the 4x4 block from themselves and the blocks right
+    // and below, producing blocks offset by one. Offset blocks gather from
+    // themselves and the blocks left and above, producing aligned blocks.
+    int shift = m_offset ? -1 : 1;
+    int tile = m_offset ? 0 : 1;
+
+    for (int y = 0; y < m_rows; y++) {
+
+        int other = (y + shift + m_rows) % m_rows;
+        const std::uint8_t *row = &m_current[std::size_t(y) * m_columns];
+        const std::uint8_t *adjacent = &m_current[std::size_t(other) * m_columns];
+        const std::uint8_t *top = m_offset ? adjacent : row;
+        const std::uint8_t *bottom = m_offset ? row : adjacent;
+        std::uint8_t *next = &m_next[std::size_t(y) * m_columns];
+
+        for (int x = 0; x < m_columns; x++) {
+
+            int side = x + shift;
+            side = side < 0 ? m_columns - 1 : side == m_columns ? 0 : side;
+            int left = m_offset ? side : x;
+            int right = m_offset ? x : side;
+
+            unsigned index = gather(top[left], top[right], bottom[right], bottom[left]);
+            std::uint8_t result = table[index];
+            next[x] = result;
+
+            // The centre of the gathered tiles is the previous generation of
+            // the tiles of the result.
+            unsigned changed = result ^ centre(index);
+            if (changed == 0)
+                continue;
+
+            for (int bit = 0; bit < 4; bit++) {
+                if (changed >> bit & 1) {
+                    Tile position(
+                        (2 * x + (bit & 1) + tile) % m_width,
+                        (2 * y + (bit >> 1) + tile) % m_height
+                    );
+                    (result >> bit & 1 ? born : died).push_back(position);
+                }
+            }
+        }
+    }
+
+    std::swap(m_current, m_next);
+    m_offset = !m_offset;
+}
+
+void LutEngine::update(int x, int y, bool alive)
+{
+    int bit = 0;
+    std::uint8_t &block = m_current[this->block(x, y, bit)];
+    block = alive ? block | 1 << bit : block & ~(1 << bit);
+}
+
+void LutEngine::clear()
+{
+    std::fill(m_current.begin(), m_current.end(), 0);
+}
+
+std::size_t LutEngine::block(int x, int y, int &bit) const
+{
+    // Offset blocks start one tile right and down, so the first tiles of the
+    // game space are the last of the wrapped blocks.
+    if (m_offset) {
+        x = (x + m_width - 1) % m_width;
+        y = (y + m_height - 1) % m_height;
+    }
+
+    bit = (x & 1) | (y & 1) << 1;
+    return std::size_t(y / 2) * m_columns + x / 2;
+}
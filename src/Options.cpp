@@ -0,0 +1,154 @@
+#include "Options.hpp"
+
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+const char *s_usage =
+    "Usage: gameoflife.exe [options]\n"
+    "\n"
+    "  --headless              Run the simulation without a window.\n"
+    "  --size WIDTH HEIGHT     Headless game space size, default 256 256.\n"
+    "  --generations N         Headless generations to run, default forever.\n"
+    "  --soup DENSITY          Start with random tiles instead of a glider.\n"
+    "  --seed SEED             Seed of the random tiles.\n"
+    "  --serve PORT            Serve an observer stream on a TCP port.\n"
+    "  --connect HOST PORT     Only view the stream served by another process.\n"
+    "  --daemon PATH           Host games driven over a Unix domain socket.\n"
+    "  --threads N             Worker threads, default one per hardware thread.\n"
+    "  --engine NAME           Headless engine: sparse, fixed, hybrid,\n"
+    "                          compressed, lut, distributed, ltl or blocked.\n"
+    "  --depth K               Generations each pass of the blocked engine\n"
+    "                          advances headless, from 1 to 64, default 8.\n"
+    "  --ltl RULE              Run headless by a Larger than Life rule, such as\n"
+    "                          R5,C0,M1,S34..58,B34..45,NM.\n"
+    "  --benchmark             Measure engine throughput and scaling.\n"
+    "  --export PATH           Export headless frames to a .y4m file, or to PNG\n"
+    "                          files starting with PATH.\n"
+    "  --export-every N        Generations between exported frames, default 1.\n"
+    "  --journal PATH          Journal the edits, pauses and speed changes.\n"
+    "  --replay PATH           Replay a journal headless and time each generation.\n"
+    "  --verify                Compare every engine with the sparse engine and\n"
+    "                          their throughput with the baseline.\n"
+    "  --baseline PATH         Baseline throughput, default baseline.json.\n"
+    "  --threshold PERCENT     Slowdown from the baseline failing, default 10.\n"
+    "  --record-baseline       Replace the baseline with the throughput measured.\n";
+
+/// Parse a TCP port, throwing std::out_of_range outside 1 to 65535 like
+/// std::stoi does outside an int.
+unsigned short parse_port(const std::string &text)
+{
+    int port = std::stoi(text);
+    if (port < 1 || port > 65535)
+        throw std::out_of_range("port");
+
+    return static_cast<unsigned short>(port);
+}
+
+}
+
+bool parse_options(int argc, char **argv, Options &options)
+{
+    // Fetch the next n arguments of an option, if there are enough.
+    int i = 1;
+    auto next = [&](int n) {
+        if (i + n >= argc) {
+            return false;
+        }
+
+        i += n;
+        return true;
+    };
+
+    for (; i < argc; i++) {
+
+        std::string option = argv[i];
+
+        try {
+            if (option == "--headless") {
+                options.headless = true;
+            }
+            else if (option == "--size" && next(2)) {
+                options.width = std::stoi(argv[i - 1]);
+                options.height = std::stoi(argv[i]);
+            }
+            else if (option == "--generations" && next(1)) {
+                options.generations = std::stoull(argv[i]);
+            }
+            else if (option == "--soup" && next(1)) {
+                options.soup = std::stod(argv[i]);
+            }
+            else if (option == "--seed" && next(1)) {
+                options.seed = std::stoul(argv[i]);
+            }
+            else if (option == "--serve" && next(1)) {
+                options.serve = parse_port(argv[i]);
+            }
+            else if (option == "--connect" && next(2)) {
+                options.connect = argv[i - 1];
+                options.connect_port = parse_port(argv[i]);
+            }
+            else if (option == "--daemon" && next(1)) {
+                options.daemon = argv[i];
+            }
+            else if (option == "--threads" && next(1)) {
+                options.threads = std::stoul(argv[i]);
+            }
+            else if (option == "--engine" && next(1)) {
+                options.engine = argv[i];
+            }
+            else if (option == "--depth" && next(1)) {
+                options.depth = std::stoi(argv[i]);
+            }
+            else if (option == "--ltl" && next(1)) {
+                options.ltl = argv[i];
+            }
+            else if (option == "--benchmark") {
+                options.benchmark = true;
+            }
+            else if (option == "--export" && next(1)) {
+                options.export_path = argv[i];
+            }
+            else if (option == "--export-every" && next(1)) {
+                options.export_every = std::stoull(argv[i]);
+            }
+            else if (option == "--journal" && next(1)) {
+                options.journal = argv[i];
+            }
+            else if (option == "--replay" && next(1)) {
+                options.replay = argv[i];
+            }
+            else if (option == "--verify") {
+                options.verify = true;
+            }
+            else if (option == "--baseline" && next(1)) {
+                options.baseline = argv[i];
+            }
+            else if (option == "--threshold" && next(1)) {
+                options.threshold = std::stod(argv[i]);
+            }
+            else if (option == "--record-baseline") {
+                options.verify = true;
+                options.record_baseline = true;
+            }
+            else {
+                std::cerr << s_usage;
+                return false;
+            }
+        }
+        catch (const std::logic_error &) {
+            // Numbers that do not parse, from std::stoi and friends.
+            std::cerr << s_usage;
+            return false;
+        }
+    }
+
+    if (options.width < 3 || options.height < 3 || options.export_every == 0 ||
+        options.depth < 1 || options.depth > 64) {
+        std::cerr << s_usage;
+        return false;
+    }
+
+    return true;
+}
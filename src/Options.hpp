@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief The command line options of the application.
+ */
+struct Options {
+
+    /// Run the simulation without a window.
+    bool headless = false;
+
+    /// The width of a headless game space in tiles.
+    int width = 256;
+
+    /// The height of a headless game space in tiles.
+    int height = 256;
+
+    /// The number of generations to run headless, or zero to run until
+    /// interrupted.
+    std::uint64_t generations = 0;
+
+    /// The probability of each tile starting alive, or zero to start with a
+    /// glider.
+    double soup = 0;
+
+    /// The seed of the random starting tiles.
+    unsigned seed = 0;
+
+    /// The port to serve the observer stream on, or zero to not serve.
+    unsigned short serve = 0;
+
+    /// The host to observe a stream from, or empty to run a simulation.
+    std::string connect;
+
+    /// The port to observe a stream from.
+    unsigned short connect_port = 0;
+
+    /// The path of the Unix domain socket to run the daemon on, or empty to
+    /// not run the daemon.
+    std::string daemon;
+
+    /// The number of worker threads, or zero for one per hardware thread.
+    std::size_t threads = 0;
+
+    /// The name of the headless engine, or empty for the fastest available.
+    std::string engine;
+
+    /// The generations each pass of the headless blocked engine advances.
+    int depth = 8;
+
+    /// The Larger than Life rule of the headless engine, or empty to run the
+    /// engine's life-like rule.
+    std::string ltl;
+
+    /// Run the engine benchmarks and exit.
+    bool benchmark = false;
+
+    /// The Y4M file or PNG file prefix to export headless frames to, or empty
+    /// to not export.
+    std::string export_path;
+
+    /// The generations between exported frames.
+    std::uint64_t export_every = 1;
+
+    /// The file to journal the actions changing the model to, or empty to not
+    /// journal.
+    std::string journal;
+
+    /// The journal to replay headless, or empty to not replay.
+    std::string replay;
+
+    /// Verify every engine against the reference engine and its throughput
+    /// against the baseline, and exit.
+    bool verify = false;
+
+    /// The JSON file of the baseline throughput of each engine.
+    std::string baseline = "baseline.json";
+
+    /// The largest slowdown from the baseline allowed, in percent.
+    double threshold = 10;
+
+    /// Replace the baseline with the measured throughput.
+    bool record_baseline = false;
+};
+
+/**
+ * @brief Parse the command line options.
+ * 
+ * @param argc The number of arguments.
+ * @param argv The arguments, starting with the program name.
+ * @param options Assigned the parsed options.
+ * @return If the arguments are valid, otherwise the usage has been printed.
+ */
+bool parse_options(int argc, char **argv, Options &options);
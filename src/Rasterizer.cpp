@@ -0,0 +1,64 @@
+#include "Rasterizer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "View.hpp"
+
+namespace {
+
+/// Pack a colour into four bytes in RGBA memory order.
+std::uint32_t pack(sf::Color colour)
+{
+    std::uint8_t bytes[4] = {colour.r, colour.g, colour.b, colour.a};
+    std::uint32_t packed;
+    std::memcpy(&packed, bytes, sizeof(packed));
+    return packed;
+}
+
+}
+
+Rasterizer::Rasterizer(int width, int height)
+    : m_width(width)
+    , m_height(height)
+    // The size of the view's texture.
+    , m_pixel_width((2 * View::s_padding + View::s_tile_size) * width + 3 * View::s_padding)
+    , m_pixel_height((2 * View::s_padding + View::s_tile_size) * height + 3 * View::s_padding)
+    , m_alive(pack(View::s_colour_alive))
+    , m_template(std::size_t(m_pixel_width) * m_pixel_height, pack(View::s_colour_background))
+{
+    std::uint32_t dead = pack(View::s_colour_dead);
+
+    for (int y = 0; y < m_height; y++) {
+        for (int x = 0; x < m_width; x++) {
+            fill(m_template.data(), x, y, dead);
+        }
+    }
+}
+
+void Rasterizer::render(const std::vector<Tile> &tiles, std::uint32_t *pixels) const
+{
+    std::copy(m_template.begin(), m_template.end(), pixels);
+
+    for (Tile tile : tiles) {
+        if (tile.x >= 0 && tile.x < m_width && tile.y >= 0 && tile.y < m_height)
+            fill(pixels, tile.x, tile.y, m_alive);
+    }
+}
+
+void Rasterizer::fill(std::uint32_t *pixels, int x, int y, std::uint32_t colour) const
+{
+    // The same position as the view's squares.
+    int left = 2 * x * View::s_padding + View::s_tile_size * x + View::s_tile_size / 2;
+    int top = 2 * y * View::s_padding + View::s_tile_size * y + View::s_tile_size / 2;
+    int right = std::min(left + View::s_tile_size, m_pixel_width);
+    int bottom = std::min(top + View::s_tile_size, m_pixel_height);
+
+    for (int row = top; row < bottom; row++) {
+        std::fill(
+            pixels + std::size_t(row) * m_pixel_width + left,
+            pixels + std::size_t(row) * m_pixel_width + right,
+            colour
+        );
+    }
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Tile.hpp"
+
+/**
+ * @brief Draws game spaces into RGBA pixel buffers on the CPU, with the same
+ * tile size, padding and colours as the view, for machines without a display
+ * or GPU.
+ * 
+ * The background and the dead tiles never change, so they are drawn once into
+ * a template that every frame starts as a copy of.
+ */
+class Rasterizer
+{
+public:
+
+    /**
+     * @brief Create a rasterizer for a game space size.
+     * 
+     * @param width The width of the game space in tiles.
+     * @param height The height of the game space in tiles.
+     */
+    Rasterizer(int width, int height);
+
+    /**
+     * @brief Draw the alive tiles of a game space.
+     * 
+     * @param tiles The alive tiles.
+     * @param pixels Assigned the pixels row major, each the four bytes of its
+     * colour in RGBA order.
+     */
+    void render(const std::vector<Tile> &tiles, std::uint32_t *pixels) const;
+
+    /**
+     * @brief Get the width of a frame.
+     * @return The width in pixels.
+     */
+    inline int pixel_width() const {
+        return m_pixel_width;
+    }
+
+    /**
+     * @brief Get the height of a frame.
+     * @return The height in pixels.
+     */
+    inline int pixel_height() const {
+        return m_pixel_height;
+    }
+
+    /**
+     * @brief Get the number of pixels of a frame.
+     * @return The number of pixels.
+     */
+    inline std::size_t size() const {
+        return m_template.size();
+    }
+
+private:
+
+    /**
+     * @brief Fill the square of a tile.
+     * 
+     * @param pixels The pixels.
+     * @param x The x position of the tile.
+     * @param y The y position of the tile.
+     * @param colour The RGBA colour in memory order.
+     */
+    void fill(std::uint32_t *pixels, int x, int y, std::uint32_t colour) const;
+
+    /// The width of the game space in tiles.
+    int m_width;
+
+    /// The height of the game space in tiles.
+    int m_height;
+
+    /// The width of a frame in pixels.
+    int m_pixel_width;
+
+    /// The height of a frame in pixels.
+    int m_pixel_height;
+
+    /// The colour of alive tiles, in memory order.
+    std::uint32_t m_alive;
+
+    /// A frame with every tile dead.
+    std::vector<std::uint32_t> m_template;
+};
@@ -0,0 +1,172 @@
+#include "Replay.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "GameOfLife.hpp"
+
+Replay::Replay(const Options &options)
+    : m_path(options.replay)
+    , m_engine(options.engine)
+    , m_threads(options.threads)
+    , m_steps("Step time")
+{}
+
+int Replay::run()
+{
+    using namespace std::chrono;
+
+    int width;
+    int height;
+    double target;
+    std::vector<JournalEntry> entries;
+
+    if (!Journal::read(m_path, width, height, target, entries)) {
+        std::cerr << "Failed to read the journal " << m_path << ".\n";
+        return 1;
+    }
+
+    // Edits are journaled by the window's thread and pauses and speed changes
+    // by the simulation thread, so an edit may be recorded after a later
+    // generation's pause. Actions of the same generation keep their order.
+    std::stable_sort(entries.begin(), entries.end(), [](const JournalEntry &a, const JournalEntry &b) {
+        return a.generation < b.generation;
+    });
+
+    std::unique_ptr<Engine> engine = m_engine.empty()
+        ? make_engine(width, height)
+        : make_engine(m_engine, width, height, m_threads);
+
+    if (!engine) {
+        std::cerr << "The " << m_engine << " engine is not available for a "
+                  << width << "x" << height << " game space.\n";
+        return 1;
+    }
+
+    // The same start as the window.
+    GameOfLife model(std::move(engine));
+    model.add_glider();
+
+    std::cout << std::fixed
+              << std::setw(24) << "Generations" << std::setw(14) << "Target"
+              << std::setw(16) << "Generations/s" << std::setw(14) << "Slowest"
+              << std::setw(12) << "At" << std::setw(10) << "Late" << "\n";
+
+    Segment segment {0, 0, target, false, 0ns, 0ns, 0, 0};
+    std::uint64_t actions = 0;
+
+    const JournalEntry *end = nullptr;
+
+    steady_clock::time_point start = steady_clock::now();
+
+    for (const JournalEntry &entry : entries) {
+
+        // Step to the generation the action was applied before.
+        while (model.generation() < entry.generation) {
+
+            steady_clock::time_point before = steady_clock::now();
+            model.advance();
+            nanoseconds step = steady_clock::now() - before;
+
+            m_steps.record(step);
+            segment.elapsed += step;
+
+            if (step > segment.slowest) {
+                segment.slowest = step;
+                segment.slowest_generation = model.generation() - 1;
+            }
+
+            // A step slower than the period could not keep to the target.
+            if (!segment.paused && !std::isinf(segment.target) && duration<double>(step).count() * segment.target > 1)
+                segment.late++;
+        }
+
+        segment.last = model.generation();
+
+        switch (entry.type) {
+        case JournalEntry::Type::PLACE  : model.place(entry.x, entry.y); break;
+        case JournalEntry::Type::REMOVE : model.remove(entry.x, entry.y); break;
+        case JournalEntry::Type::CLEAR  : model.clear(); break;
+        case JournalEntry::Type::END    : end = &entry; break;
+
+        case JournalEntry::Type::PAUSE:
+        case JournalEntry::Type::RESUME:
+        case JournalEntry::Type::SPEED:
+            print(segment);
+
+            segment = Segment {
+                model.generation(),
+                model.generation(),
+                entry.type == JournalEntry::Type::SPEED ? entry.target : segment.target,
+                entry.type == JournalEntry::Type::PAUSE ||
+                    (entry.type == JournalEntry::Type::SPEED && segment.paused),
+                0ns, 0ns, 0, 0
+            };
+            break;
+        }
+
+        actions++;
+
+        if (end)
+            break;
+    }
+
+    print(segment);
+
+    double seconds = duration_cast<duration<double>>(steady_clock::now() - start).count();
+
+    std::cout << "\n"
+              << "Engine:      " << model.engine() << "\n"
+              << "Generations: " << model.generation() << "\n"
+              << "Actions:     " << actions << "\n"
+              << "Seconds:     " << seconds << "\n"
+              << "Rate:        " << model.generation() / seconds << " generations/s\n"
+              << "Population:  " << model.population() << "\n\n";
+
+    m_steps.dump(std::cout);
+
+    // A journal cut short by a crash has no end to verify against.
+    if (!end) {
+        std::cout << "\nThe journal has no end, replayed up to its last action.\n";
+        return 0;
+    }
+
+    if (Journal::fingerprint(model) != end->fingerprint) {
+        std::cerr << "\nThe replay diverged from the journaled session.\n";
+        return 1;
+    }
+
+    std::cout << "\nThe replay matches the journaled session.\n";
+    return 0;
+}
+
+void Replay::print(const Segment &segment)
+{
+    using namespace std::chrono;
+
+    double seconds = duration_cast<duration<double>>(segment.elapsed).count();
+
+    std::string generations = std::to_string(segment.first) + "-" + std::to_string(segment.last);
+    std::string target = segment.paused ? "paused" : std::isinf(segment.target) ? "unlimited" : "";
+
+    std::cout << std::setw(24) << generations;
+
+    if (target.empty())
+        std::cout << std::setprecision(1) << std::setw(14) << segment.target;
+    else
+        std::cout << std::setw(14) << target;
+
+    // A segment without steps has no rate.
+    if (segment.last == segment.first) {
+        std::cout << std::setw(16) << "-" << std::setw(14) << "-" << std::setw(12) << "-" << std::setw(10) << "-" << "\n";
+        return;
+    }
+
+    std::cout << std::setprecision(1) << std::setw(16) << (segment.last - segment.first) / seconds
+              << std::setprecision(3) << std::setw(12) << duration<double, std::milli>(segment.slowest).count() << "ms"
+              << std::setw(12) << segment.slowest_generation
+              << std::setw(10) << segment.late << "\n";
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "Histogram.hpp"
+#include "Journal.hpp"
+#include "Options.hpp"
+
+/**
+ * @brief Replays a journal headless, applying every action at the generation
+ * it was recorded at, and times every generation.
+ * 
+ * The model starts from the same glider as the window, so the replay reaches
+ * the same state as the journaled session, which the fingerprint at the end of
+ * the journal verifies. Generations run as fast as possible, and are reported
+ * per stretch between pauses and speed changes against the target rate of the
+ * session, so a stutter becomes a repeatable benchmark.
+ */
+class Replay
+{
+public:
+
+    /**
+     * @brief Create the replay described by the options.
+     * @param options The command line options.
+     */
+    Replay(const Options &options);
+
+    /**
+     * @brief Replay the journal and print the timings.
+     * @return The exit code of the application.
+     */
+    int run();
+
+private:
+
+    /// The generations between two pauses or speed changes.
+    struct Segment {
+
+        /// The first generation stepped.
+        std::uint64_t first;
+
+        /// The generation after the last stepped.
+        std::uint64_t last;
+
+        /// The target generations per second of the session.
+        double target;
+
+        /// If the session was paused.
+        bool paused;
+
+        /// The time spent stepping.
+        std::chrono::nanoseconds elapsed;
+
+        /// The slowest step, and the generation it stepped from.
+        std::chrono::nanoseconds slowest;
+        std::uint64_t slowest_generation;
+
+        /// The number of steps slower than the target period.
+        std::uint64_t late;
+    };
+
+    /**
+     * @brief Print a segment.
+     * @param segment The segment.
+     */
+    void print(const Segment &segment);
+
+    /// The path of the journal.
+    std::string m_path;
+
+    /// The name of the engine, or empty for the fastest available.
+    std::string m_engine;
+
+    /// The number of workers of engines that have them.
+    std::size_t m_threads;
+
+    /// The time to step each generation.
+    Histogram m_steps;
+};
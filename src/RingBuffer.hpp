@@ -0,0 +1,110 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @brief A bounded single producer, single consumer queue of preallocated
+ * slots.
+ * 
+ * Slots are never constructed or destroyed while queued, so the producer
+ * fills a slot in place and objects such as vectors keep their capacity from
+ * one use to the next. Neither side ever blocks, a full or empty queue is
+ * reported by returning nullptr.
+ * 
+ * @tparam T The slot type.
+ * @tparam N The number of slots.
+ */
+template<typename T, std::size_t N>
+class RingBuffer
+{
+public:
+
+    /**
+     * @brief Get the next free slot for the producer to fill.
+     * @return The free slot, or nullptr if the queue is full.
+     */
+    T *write_slot()
+    {
+        std::size_t head = m_head.load(std::memory_order_relaxed);
+
+        if (head - m_tail.load(std::memory_order_acquire) == N) {
+            return nullptr;
+        }
+
+        return &m_slots[head % N];
+    }
+
+    /**
+     * @brief Publish the slot returned by write_slot() to the consumer.
+     */
+    void push()
+    {
+        m_head.store(
+            m_head.load(std::memory_order_relaxed) + 1,
+            std::memory_order_release
+        );
+    }
+
+    /**
+     * @brief Get the oldest published slot for the consumer to read.
+     * @return The oldest slot, or nullptr if the queue is empty.
+     */
+    T *read_slot()
+    {
+        std::size_t tail = m_tail.load(std::memory_order_relaxed);
+
+        if (tail == m_head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+
+        return &m_slots[tail % N];
+    }
+
+    /**
+     * @brief Skip every published slot except the newest, returning them to
+     * the producer, and get the newest for the consumer to read.
+     * 
+     * @return The newest slot, or nullptr if the queue is empty.
+     */
+    T *latest_slot()
+    {
+        std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        std::size_t head = m_head.load(std::memory_order_acquire);
+
+        if (tail == head) {
+            return nullptr;
+        }
+
+        if (head - tail > 1) {
+            m_tail.store(head - 1, std::memory_order_release);
+        }
+
+        return &m_slots[(head - 1) % N];
+    }
+
+    /**
+     * @brief Return the slot returned by read_slot() or latest_slot() to the
+     * producer.
+     */
+    void pop()
+    {
+        m_tail.store(
+            m_tail.load(std::memory_order_relaxed) + 1,
+            std::memory_order_release
+        );
+    }
+
+private:
+
+    /// The slots, indexed by a position modulo N.
+    std::array<T, N> m_slots {};
+
+    /// Position of the next slot to be written, only stored by the producer.
+    /// Kept on its own cache line to the consumer's position.
+    alignas(64) std::atomic_size_t m_head {0};
+
+    /// Position of the next slot to be read, only stored by the consumer.
+    alignas(64) std::atomic_size_t m_tail {0};
+};
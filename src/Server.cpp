@@ -0,0 +1,229 @@
+#include "Server.hpp"
+
+#include <iostream>
+
+#include "Stream.hpp"
+
+Server::Server(GameOfLife &model, unsigned short port)
+    : m_model(model)
+    , m_deltas()
+    , m_changes()
+    , m_taken()
+    , m_resync(true)
+    , m_observing(0)
+    , m_listening(false)
+    , m_listener()
+    , m_mirror()
+    , m_mirrored(false)
+    , m_generation(0)
+    , m_observers()
+{
+    if (m_listener.listen(port) != sf::Socket::Done) {
+        std::cerr << "Failed to serve on port " << port << ".\n";
+        return;
+    }
+
+    m_listening = true;
+    m_model.track_changes(true);
+
+    m_thread = std::jthread([this](std::stop_token stop) {
+        network_thread(stop);
+    });
+}
+
+Server::~Server()
+{
+    if (m_thread.joinable()) {
+        m_thread.request_stop();
+        m_thread.join();
+    }
+
+    m_model.track_changes(false);
+}
+
+void Server::publish()
+{
+    if (!m_listening) {
+        return;
+    }
+
+    std::uint64_t generation = m_model.take_changes(m_taken);
+
+    // Nobody is watching, so the mirror will need a keyframe when they do.
+    if (m_observing == 0) {
+        m_taken.clear();
+        m_changes.clear();
+        m_resync = true;
+        return;
+    }
+
+    m_changes.insert(m_changes.end(), m_taken.begin(), m_taken.end());
+    m_taken.clear();
+
+    // Once the changes waiting for the network thread outgrow the game space,
+    // a keyframe is smaller.
+    if (m_changes.size() > 2 * m_model.population() + 4096) {
+        m_changes.clear();
+        m_resync = true;
+    }
+
+    if (!m_resync && m_changes.empty()) {
+        return;
+    }
+
+    // Coalesce changes until the network thread catches up.
+    Delta *delta = m_deltas.write_slot();
+    if (!delta) {
+        return;
+    }
+
+    if (m_resync.exchange(false)) {
+        delta->keyframe = true;
+        delta->generation = m_model.snapshot(delta->tiles);
+        m_changes.clear();
+    }
+    else {
+        delta->keyframe = false;
+        delta->generation = generation;
+        delta->changes.clear();
+        delta->changes.swap(m_changes);
+    }
+
+    m_deltas.push();
+}
+
+void Server::network_thread(std::stop_token stop)
+{
+    sf::SocketSelector selector;
+    selector.add(m_listener);
+
+    std::unique_ptr<sf::TcpSocket> socket = std::make_unique<sf::TcpSocket>();
+
+    while (!stop.stop_requested()) {
+
+        // Wake promptly for new observers, otherwise send at a steady rate.
+        if (selector.wait(sf::milliseconds(10)) && selector.isReady(m_listener)) {
+            if (m_listener.accept(*socket) == sf::Socket::Done) {
+                socket->setBlocking(false);
+
+                m_observers.push_back(Observer(std::move(socket), {}, true, false, {}));
+                socket = std::make_unique<sf::TcpSocket>();
+
+                // The mirror is not maintained while nobody is watching.
+                if (m_observing++ == 0) {
+                    m_mirrored = false;
+                    m_resync = true;
+                }
+            }
+        }
+
+        while (Delta *delta = m_deltas.read_slot()) {
+            apply(*delta);
+            m_deltas.pop();
+        }
+
+        if (!m_mirrored) {
+            continue;
+        }
+
+        std::erase_if(m_observers, [&](Observer &observer) {
+            if (flush(observer)) {
+                return false;
+            }
+
+            m_observing--;
+            return true;
+        });
+    }
+}
+
+void Server::apply(Delta &delta)
+{
+    m_generation = delta.generation;
+
+    if (delta.keyframe) {
+        m_mirror.clear();
+        m_mirror.insert(delta.tiles.begin(), delta.tiles.end());
+        m_mirrored = true;
+
+        for (Observer &observer : m_observers) {
+            observer.keyframe = true;
+            observer.pending.clear();
+        }
+
+        return;
+    }
+
+    for (Change change : delta.changes) {
+        if (change.alive)
+            m_mirror.insert(change.tile);
+        else
+            m_mirror.erase(change.tile);
+    }
+
+    for (Observer &observer : m_observers) {
+        if (observer.keyframe)
+            continue;
+
+        for (Change change : delta.changes)
+            observer.pending[change.tile] = change.alive;
+    }
+}
+
+bool Server::flush(Observer &observer)
+{
+    // A packet that was partially sent must be resent unmodified.
+    if (observer.sending) {
+        sf::Socket::Status status = observer.socket->send(observer.packet);
+
+        if (status == sf::Socket::Partial)
+            return true;
+        if (status != sf::Socket::Done)
+            return false;
+
+        observer.sending = false;
+    }
+
+    // Coalesced changes that outgrow the game space are sent as a keyframe.
+    if (observer.pending.size() > m_mirror.size())
+        observer.keyframe = true;
+
+    if (!observer.keyframe && observer.pending.empty())
+        return true;
+
+    sf::Packet &packet = observer.packet;
+    packet.clear();
+
+    MessageType type = observer.keyframe ? MessageType::KEYFRAME : MessageType::DELTA;
+    packet << sf::Uint8(type)
+           << sf::Uint32(m_model.width())
+           << sf::Uint32(m_model.height())
+           << sf::Uint64(m_generation);
+
+    if (observer.keyframe) {
+        std::vector<Tile> alive(m_mirror.begin(), m_mirror.end());
+        write_tiles(packet, alive, m_model.width());
+    }
+    else {
+        std::vector<Tile> born;
+        std::vector<Tile> died;
+
+        for (auto [tile, alive] : observer.pending)
+            (alive ? born : died).push_back(tile);
+
+        write_tiles(packet, born, m_model.width());
+        write_tiles(packet, died, m_model.width());
+    }
+
+    observer.keyframe = false;
+    observer.pending.clear();
+
+    sf::Socket::Status status = observer.socket->send(packet);
+
+    if (status == sf::Socket::Partial)
+        observer.sending = true;
+    else if (status != sf::Socket::Done)
+        return false;
+
+    return true;
+}
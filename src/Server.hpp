@@ -0,0 +1,159 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <SFML/Network.hpp>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "GameOfLife.hpp"
+#include "RingBuffer.hpp"
+
+/**
+ * @brief Serves the changes of a game of life to observers over TCP.
+ * 
+ * The thread stepping the model publishes its changes after each step, into a
+ * queue drained by the server's own network thread. The network thread keeps
+ * a mirror of the game space, sends each observer a keyframe when it connects
+ * and then batches every change since its last send into one delta.
+ * 
+ * Nothing the observers do can slow the model down. Changes of an observer
+ * that cannot keep up are coalesced until its socket is ready, and if the
+ * network thread itself falls behind the queued changes are dropped and
+ * replaced by a keyframe.
+ */
+class Server
+{
+public:
+
+    /**
+     * @brief Start serving a game of life.
+     * 
+     * @param model The game of life to serve, which must outlive the server.
+     * @param port The TCP port to listen on.
+     */
+    Server(GameOfLife &model, unsigned short port);
+
+    /**
+     * @brief Stop serving and disconnect all observers.
+     */
+    ~Server();
+
+    /**
+     * @brief Publish the changes of the model since the last call. Only called
+     * by the thread stepping the model, and never waits for the network.
+     */
+    void publish();
+
+    /**
+     * @brief If the server is listening for observers.
+     * @return If the server is listening.
+     */
+    inline bool listening() const {
+        return m_listening;
+    }
+
+private:
+
+    /// Changes published by the model thread for the network thread.
+    struct Delta {
+
+        /// If the tiles are the whole game space rather than changes.
+        bool keyframe;
+
+        /// The generation after the changes.
+        std::uint64_t generation;
+
+        /// The changes in order, when not a keyframe.
+        std::vector<Change> changes;
+
+        /// The alive tiles, when a keyframe.
+        std::vector<Tile> tiles;
+    };
+
+    /// A connected observer.
+    struct Observer {
+
+        /// The connection to the observer.
+        std::unique_ptr<sf::TcpSocket> socket;
+
+        /// The latest state of each tile changed since the last send.
+        std::unordered_map<Tile, bool> pending;
+
+        /// If the next send is a keyframe.
+        bool keyframe;
+
+        /// If the packet has only been partially sent.
+        bool sending;
+
+        /// The packet being sent.
+        sf::Packet packet;
+    };
+
+    /**
+     * @brief Accepts observers, applies published changes to the mirror and
+     * sends them to each observer.
+     * 
+     * @param stop The stop signal issued to the thread to exit.
+     */
+    void network_thread(std::stop_token stop);
+
+    /**
+     * @brief Apply published changes to the mirror and every observer.
+     * @param delta The published changes.
+     */
+    void apply(Delta &delta);
+
+    /**
+     * @brief Continue sending to an observer, and start sending its pending
+     * changes if it has finished.
+     * 
+     * @param observer The observer.
+     * @return If the observer is still connected.
+     */
+    bool flush(Observer &observer);
+
+    /// The game of life being served.
+    GameOfLife &m_model;
+
+    /// Changes queued from the model thread to the network thread.
+    RingBuffer<Delta, 64> m_deltas;
+
+    /// Changes taken from the model but not yet queued. Only used by the model
+    /// thread.
+    std::vector<Change> m_changes;
+
+    /// Changes most recently taken from the model. Only used by the model
+    /// thread.
+    std::vector<Change> m_taken;
+
+    /// If the model thread must queue a keyframe, because changes were
+    /// dropped or the mirror was discarded.
+    std::atomic_bool m_resync;
+
+    /// The number of connected observers.
+    std::atomic_size_t m_observing;
+
+    /// If the listener was opened.
+    bool m_listening;
+
+    /// Listener accepting observers.
+    sf::TcpListener m_listener;
+
+    /// The game space as last published. Only used by the network thread.
+    std::unordered_set<Tile> m_mirror;
+
+    /// If the mirror has received a keyframe since observers connected.
+    bool m_mirrored;
+
+    /// The generation of the mirror.
+    std::uint64_t m_generation;
+
+    /// The connected observers.
+    std::vector<Observer> m_observers;
+
+    /// Thread sending to observers.
+    std::jthread m_thread;
+};
@@ -0,0 +1,122 @@
+#include "SparseEngine.hpp"
+
+#include <unordered_map>
+
+SparseEngine::SparseEngine(int width, int height)
+    : Engine(width, height)
+    , m_space()
+{}
+
+std::array<Tile, 8> SparseEngine::neighbors(Tile tile)
+{
+    // Should probably be inlined.
+
+    // Return the number wrapped around between 0 and n. If a > n, then  repeat
+    // a - n until a < n.
+    auto wrap = [](int a, int n) {
+        return ((a % n) + n) % n;
+    };
+
+    // Cardinal neighbors.
+    int above = wrap(tile.y - 1, m_height);
+    int below = wrap(tile.y + 1, m_height);
+    int left = wrap(tile.x - 1, m_width);
+    int right = wrap(tile.x + 1, m_width);
+
+    // Starting with north, this is a sequence of compass directions.
+    return {
+        Tile(tile.x, above), // North
+        Tile(right, above),  // North East
+        Tile(right, tile.y), // East
+        Tile(right, below),  // South East
+        Tile(tile.x, below), // South
+        Tile(left, below),   // South West
+        Tile(left, tile.y),  // West
+        Tile(left, above)    // North West
+    };
+}
+
+int SparseEngine::count(Tile tile)
+{
+    int n = 0;
+
+    // Increment all neighbors.
+    for (auto neighbor : neighbors(tile)) {
+        if (m_space.contains(neighbor)) {
+            n++;
+        }
+    };
+
+    return n;
+}
+
+void SparseEngine::advance(std::vector<Tile> &born, std::vector<Tile> &died)
+{
+    /// @todo Multithreading with a std::latch and a thread pool. This algorithm
+    /// is threadable because it only reads from the current game space when
+    /// calculating the next iteration.
+
+    // Surrounding alive counts of each tile.
+    std::unordered_map<Tile, int> counts;
+
+    for (auto tile : m_space) {
+
+        int n = 0;
+
+        // Count the number of alive neighbors. For all the dead neighbors,
+        // count their alive neighbors if they are not already counted.
+        for (auto neighbor : neighbors(tile)) {
+            if (m_space.contains(neighbor)) {
+                n++;
+            }
+            else if (!counts.contains(neighbor)) {
+                counts.emplace(neighbor, count(neighbor));
+            }
+        };
+
+        counts.emplace(tile, n);
+    }
+
+    // These lines of code make up the logic of the simulation!
+    for (auto [tile, n] : counts) {
+
+        // If the tile was alive last iteration.
+        auto it = m_space.find(tile);
+        bool alive = it != m_space.end();
+
+        if (alive && (m_rule.survival >> n & 1)) {
+            continue;
+        }
+        else if (!alive && (m_rule.birth >> n & 1)) {
+            m_space.insert(tile);
+            born.push_back(tile);
+        }
+        else if (alive) {
+            m_space.erase(it);
+            died.push_back(tile);
+        }
+    }
+}
+
+void SparseEngine::update(int x, int y, bool alive)
+{
+    if (alive) {
+        m_space.insert(Tile(x, y));
+    }
+    else {
+        m_space.erase(Tile(x, y));
+    }
+}
+
+void SparseEngine::clear()
+{
+    m_space.clear();
+}
+
+std::size_t SparseEngine::memory() const
+{
+    // Each tile is a node holding the tile, its hash and the next node, and
+    // each bucket is a pointer.
+    return m_space.size() * (sizeof(Tile) + sizeof(std::size_t) + sizeof(void*))
+         + m_space.bucket_count() * sizeof(void*);
+}
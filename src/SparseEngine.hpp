@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <unordered_set>
+
+#include "Engine.hpp"
+
+/**
+ * @brief The reference engine, storing alive tiles in a hash set and counting
+ * the neighbors of every alive tile and its dead neighbors each generation.
+ * 
+ * Works for any game space size and its cost only depends on the number of
+ * alive tiles, so it suits large and sparse game spaces.
+ */
+class SparseEngine : public Engine
+{
+public:
+
+    /// Type describing all alive tiles.
+    using Space = std::unordered_set<Tile>;
+
+    /**
+     * @brief Create an engine with an empty game space.
+     * 
+     * @param width The width of the grid in tiles.
+     * @param height The height of the grid in tiles.
+     */
+    SparseEngine(int width, int height);
+
+    void advance(std::vector<Tile> &born, std::vector<Tile> &died) override;
+    void update(int x, int y, bool alive) override;
+    void clear() override;
+
+    std::string name() const override {
+        return "sparse";
+    }
+
+    std::size_t memory() const override;
+
+private:
+
+    /**
+     * @brief Returns all the neighboring tiles of a tile.
+     * 
+     * @param tile The tile to find the neighbors of.
+     * @return The neighboring tiles.
+     */
+    std::array<Tile, 8> neighbors(Tile tile);
+
+    /**
+     * @brief Returns the number of alive tiles around one.
+     * 
+     * @param tile The tile to count the number of alive tiles around.
+     * @return The number of alive tiles surrounding the tile.
+     */
+    int count(Tile tile);
+
+    /// The alive tiles.
+    Space m_space;
+};
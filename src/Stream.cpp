@@ -0,0 +1,72 @@
+#include "Stream.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+void write_tiles(sf::Packet &packet, std::vector<Tile> &tiles, int width)
+{
+    auto index = [width](Tile tile) {
+        return std::uint64_t(tile.y) * width + tile.x;
+    };
+
+    std::sort(tiles.begin(), tiles.end(), [&](Tile a, Tile b) {
+        return index(a) < index(b);
+    });
+
+    packet << sf::Uint32(tiles.size());
+
+    // Seven bits per byte, with the top bit set on all but the last byte.
+    std::vector<sf::Uint8> bytes;
+    bytes.reserve(tiles.size() * 2);
+
+    std::uint64_t previous = 0;
+    for (Tile tile : tiles) {
+        std::uint64_t gap = index(tile) - previous;
+        previous = index(tile);
+
+        do {
+            sf::Uint8 byte = gap & 0x7F;
+            gap >>= 7;
+            bytes.push_back(gap ? byte | 0x80 : byte);
+        } while (gap);
+    }
+
+    packet.append(bytes.data(), bytes.size());
+}
+
+bool read_tiles(sf::Packet &packet, std::vector<Tile> &tiles, int width, int height)
+{
+    sf::Uint32 count = 0;
+    if (!(packet >> count)) {
+        return false;
+    }
+
+    const std::uint64_t size = std::uint64_t(width) * height;
+
+    tiles.clear();
+    tiles.reserve(std::min<std::uint64_t>(count, size));
+
+    std::uint64_t index = 0;
+    for (sf::Uint32 i = 0; i < count; i++) {
+
+        std::uint64_t gap = 0;
+        sf::Uint8 byte = 0x80;
+
+        for (int shift = 0; byte & 0x80; shift += 7) {
+            if (shift > 63 || !(packet >> byte)) {
+                return false;
+            }
+
+            gap |= std::uint64_t(byte & 0x7F) << shift;
+        }
+
+        index += gap;
+        if (index >= size) {
+            return false;
+        }
+
+        tiles.push_back(Tile(index % width, index / width));
+    }
+
+    return true;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <SFML/Network.hpp>
+#include <vector>
+
+#include "Tile.hpp"
+
+/**
+ * @brief Types of message in the observer stream served by Server to Client.
+ * 
+ * Every message starts with its type, the game space width and height, and the
+ * generation it brings the observer to.
+ * - A KEYFRAME is followed by every alive tile. It is always the first message
+ *   and replaces the observer's game space.
+ * - A DELTA is followed by the tiles that became alive, then the tiles that
+ *   died, since the previous message. Any number of generations may be
+ *   coalesced into one delta.
+ */
+enum class MessageType : sf::Uint8 {
+    KEYFRAME,
+    DELTA
+};
+
+/**
+ * @brief Write a list of tiles to a packet. The tiles are sorted row major and
+ * each written as the variable length gap from the previous tile's index, so
+ * clustered tiles take a byte or two each.
+ * 
+ * @param packet The packet to append to.
+ * @param tiles The tiles, which are sorted.
+ * @param width The width of the game space.
+ */
+void write_tiles(sf::Packet &packet, std::vector<Tile> &tiles, int width);
+
+/**
+ * @brief Read a list of tiles written by write_tiles().
+ * 
+ * @param packet The packet to read from.
+ * @param tiles Assigned the tiles.
+ * @param width The width of the game space.
+ * @param height The height of the game space.
+ * @return If the tiles were read and are inside the game space.
+ */
+bool read_tiles(sf::Packet &packet, std::vector<Tile> &tiles, int width, int height);
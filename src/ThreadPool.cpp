@@ -0,0 +1,66 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(std::size_t threads)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (std::size_t i = 0; i < threads; i++) {
+        m_threads.emplace_back([this](std::stop_token stop) {
+            worker(stop);
+        });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    stop();
+}
+
+void ThreadPool::stop()
+{
+    for (std::jthread &thread : m_threads)
+        thread.request_stop();
+
+    m_condition.notify_all();
+
+    for (std::jthread &thread : m_threads) {
+        if (thread.joinable())
+            thread.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+
+    m_condition.notify_one();
+}
+
+void ThreadPool::worker(std::stop_token stop)
+{
+    for (;;) {
+
+        std::function<void()> task;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            m_condition.wait(lock, stop, [&]{ return !m_tasks.empty(); });
+
+            // Check for exit signal
+            if (stop.stop_requested())
+                break;
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+
+        task();
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief A fixed number of worker threads running tasks in the order they are
+ * submitted.
+ */
+class ThreadPool
+{
+public:
+
+    /**
+     * @brief Start the worker threads.
+     * @param threads The number of threads, or zero for one per hardware
+     * thread.
+     */
+    ThreadPool(std::size_t threads = 0);
+
+    /**
+     * @brief Stop the worker threads, discarding tasks that have not started.
+     */
+    ~ThreadPool();
+
+    /**
+     * @brief Stop the worker threads and wait for the tasks they are running
+     * to finish, discarding tasks that have not started. Tasks submitted
+     * after stopping never run.
+     */
+    void stop();
+
+    /**
+     * @brief Queue a task to be run by the next free worker.
+     * @param task The task.
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief Get the number of worker threads.
+     * @return The number of worker threads.
+     */
+    inline std::size_t size() const {
+        return m_threads.size();
+    }
+
+private:
+
+    /**
+     * @brief Joinable thread running tasks until stopped.
+     * @param stop The stop signal issued to the thread to exit.
+     */
+    void worker(std::stop_token stop);
+
+    /// Mutex protecting the queue of tasks.
+    std::mutex m_mutex;
+
+    /// Condition variable notifying workers of new tasks.
+    std::condition_variable_any m_condition;
+
+    /// Tasks waiting for a worker.
+    std::deque<std::function<void()>> m_tasks;
+
+    /// The worker threads.
+    std::vector<std::jthread> m_threads;
+};
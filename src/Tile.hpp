@@ -0,0 +1,44 @@
+#pragma once
+
+#include <functional>
+
+/// Type describing a tile.
+struct Tile {
+    int x;
+    int y;
+};
+
+// Hash function for Tile.
+template<>
+struct std::hash<Tile>
+{
+    size_t operator()(const Tile& tile) const noexcept
+    {
+        size_t hx = hash<int>{}(tile.x);
+        size_t hy = hash<int>{}(tile.y);
+        return hx ^ (hy + 0x9e3779b9 + (hx << 6) + (hx >> 2));
+    }
+};
+
+inline bool operator==(const Tile &left, const Tile &right) {
+    return left.x == right.x && left.y == right.y;
+}
+
+/// Type describing a rectangle of tiles with its top left tile at (x, y).
+struct Region {
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+inline bool operator==(const Region &left, const Region &right) {
+    return left.x == right.x && left.y == right.y
+        && left.width == right.width && left.height == right.height;
+}
+
+/// Type describing a tile changing state.
+struct Change {
+    Tile tile;
+    bool alive;
+};
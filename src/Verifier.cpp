@@ -0,0 +1,583 @@
+#include "Verifier.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+
+#include "BlockedEngine.hpp"
+#include "Client.hpp"
+#include "Server.hpp"
+
+namespace {
+
+/// The engines compared with the reference, in the order they are printed.
+const char *s_engines[] = {"fixed", "hybrid", "compressed", "lut", "distributed", "ltl", "blocked"};
+
+/// The depths of the passes the blocked engine is also compared in.
+const int s_depths[] = {3, 8, BlockedEngine::s_max_depth};
+
+/// The reference engine.
+const char *s_reference = "sparse";
+
+/// Conway's rule as a Larger than Life rule.
+constexpr LtlRule s_ltl_conway = {1, false, false, 3, 3, 2, 3};
+
+/// The square game space size served over loopback.
+constexpr int s_stream_size = 128;
+
+/// The generations the game served over loopback is stepped.
+constexpr std::uint64_t s_stream_generations = 200;
+
+/// The port the game is served on over loopback.
+constexpr unsigned short s_stream_port = 47321;
+
+/// The longest time for the client to receive the last generation.
+constexpr std::chrono::seconds s_stream_timeout(10);
+
+/// The square game space size the throughput is measured on.
+constexpr int s_throughput_size = 256;
+
+/// The time each round of a throughput measurement runs for.
+constexpr std::chrono::milliseconds s_budget(300);
+
+/// The rounds of each throughput measurement.
+constexpr int s_rounds = 3;
+
+/// The most differing tiles listed each way.
+constexpr std::size_t s_listed = 8;
+
+/// The tiles shown on each side of the first differing tile.
+constexpr int s_map_radius = 4;
+
+/// Order tiles by row, then column.
+bool before(const Tile &left, const Tile &right)
+{
+    return left.y != right.y ? left.y < right.y : left.x < right.x;
+}
+
+/**
+ * @brief Read a baseline, a flat JSON object of numbers.
+ * 
+ * @param path The path of the baseline.
+ * @param rates Assigned the rate of each engine.
+ * @return If the file exists and is a valid baseline.
+ */
+bool read_baseline(const std::string &path, std::map<std::string, double> &rates)
+{
+    std::ifstream file(path);
+    if (!file)
+        return false;
+
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string text = buffer.str();
+    std::size_t i = 0;
+
+    auto skip = [&] {
+        while (i < text.size() && std::isspace(static_cast<unsigned char>(text[i])))
+            i++;
+    };
+
+    auto expect = [&](char c) {
+        skip();
+        if (i >= text.size() || text[i] != c)
+            return false;
+        i++;
+        return true;
+    };
+
+    if (!expect('{'))
+        return false;
+
+    rates.clear();
+
+    skip();
+    if (i < text.size() && text[i] == '}')
+        return true;
+
+    do {
+        if (!expect('"'))
+            return false;
+
+        std::size_t end = text.find('"', i);
+        if (end == std::string::npos)
+            return false;
+
+        std::string name = text.substr(i, end - i);
+        i = end + 1;
+
+        if (!expect(':'))
+            return false;
+
+        skip();
+        std::size_t length = 0;
+        try {
+            rates[name] = std::stod(text.substr(i), &length);
+        }
+        catch (const std::logic_error &) {
+            return false;
+        }
+        i += length;
+    }
+    while (expect(','));
+
+    return expect('}');
+}
+
+/**
+ * @brief Write a baseline as a flat JSON object.
+ * 
+ * @param path The path of the baseline.
+ * @param rates The rate of each engine.
+ * @return If the file was written.
+ */
+bool write_baseline(const std::string &path, const std::map<std::string, double> &rates)
+{
+    std::ofstream file(path);
+    file << std::fixed << std::setprecision(1) << "{\n";
+
+    std::size_t i = 0;
+    for (const auto &[name, rate] : rates)
+        file << "    \"" << name << "\": " << rate << (++i < rates.size() ? ",\n" : "\n");
+
+    file << "}\n";
+    return bool(file);
+}
+
+}
+
+Verifier::Verifier(const Options &options)
+    : m_baseline(options.baseline)
+    , m_threshold(options.threshold)
+    , m_record(options.record_baseline)
+    , m_threads(options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency()))
+{}
+
+int Verifier::run()
+{
+    std::cout << std::fixed
+              << "Verification against the " << s_reference << " engine\n"
+              << std::left << std::setw(28) << "Case" << std::setw(12) << "Size"
+              << std::right << std::setw(12) << "Generations" << "  Engines\n";
+
+    bool matched = true;
+    for (const Case &test : cases())
+        matched = verify(test) && matched;
+
+    matched = stream() && matched;
+
+    std::cout << "\n";
+
+    bool fast = throughput();
+
+    if (!matched)
+        std::cerr << "An engine diverged from the " << s_reference << " engine.\n";
+
+    if (!fast)
+        std::cerr << "An engine is more than " << m_threshold << "% slower than its baseline.\n";
+
+    return matched && fast ? 0 : 1;
+}
+
+std::vector<Verifier::Case> Verifier::cases() const
+{
+    Rule highlife;
+    parse_rule("B36/S23", highlife);
+
+    // Place a pattern with its tiles wrapped onto the game space.
+    auto place = [](GameOfLife &model, int x, int y, const std::vector<Tile> &tiles) {
+        for (Tile tile : tiles) {
+            model.place(
+                ((x + tile.x) % model.width() + model.width()) % model.width(),
+                ((y + tile.y) % model.height() + model.height()) % model.height()
+            );
+        }
+    };
+
+    const std::vector<Tile> glider = {{1, 0}, {2, 1}, {0, 2}, {1, 2}, {2, 2}};
+    const std::vector<Tile> lwss = {{1, 0}, {4, 0}, {0, 1}, {0, 2}, {4, 2}, {0, 3}, {1, 3}, {2, 3}, {3, 3}};
+    const std::vector<Tile> blinker = {{-1, 0}, {0, 0}, {1, 0}};
+    const std::vector<Tile> r_pentomino = {{1, 0}, {2, 0}, {0, 1}, {1, 1}, {1, 2}};
+
+    return {
+        {"soup", 64, 64, s_conway, 300, [](GameOfLife &model) { model.add_soup(0.3, 1); }},
+        {"soup, display size", 96, 54, s_conway, 300, [](GameOfLife &model) { model.add_soup(0.35, 2); }},
+        {"soup, odd size", 37, 23, s_conway, 300, [](GameOfLife &model) { model.add_soup(0.3, 3); }},
+        {"soup, HighLife", 64, 64, highlife, 300, [](GameOfLife &model) { model.add_soup(0.3, 4); }},
+        {"soup, dense", 256, 256, s_conway, 100, [](GameOfLife &model) { model.add_soup(0.6, 5); }},
+        {"soup, wide", 2048, 80, s_conway, 40, [](GameOfLife &model) { model.add_soup(0.3, 8); }},
+        {"soup, thin", 200, 3, s_conway, 100, [](GameOfLife &model) { model.add_soup(0.4, 6); }},
+        {"soup, smallest", 3, 3, s_conway, 20, [](GameOfLife &model) { model.add_soup(0.5, 7); }},
+        {"glider through a corner", 32, 32, s_conway, 200, [=](GameOfLife &model) {
+            place(model, 28, 28, glider);
+        }},
+        {"spaceship across an edge", 40, 20, s_conway, 200, [=](GameOfLife &model) {
+            place(model, 2, 8, lwss);
+        }},
+        {"blinkers on the seams", 16, 16, s_conway, 10, [=](GameOfLife &model) {
+            place(model, 0, 5, blinker);
+            place(model, 8, 0, blinker);
+            place(model, 15, 15, blinker);
+        }},
+        {"R-pentomino", 128, 72, s_conway, 1000, [=](GameOfLife &model) {
+            place(model, 63, 35, r_pentomino);
+        }},
+        {"Gosper glider gun", 64, 64, s_conway, 500, [](GameOfLife &model) {
+            model.load(10, 10,
+                "24bo$22bobo$12b2o6b2o12b2o$11bo3bo4b2o12b2o$2o8bo5bo3b2o$"
+                "2o8bo3bob2o4bobo$10bo5bo7bo$11bo3bo$12b2o!");
+        }},
+    };
+}
+
+std::unique_ptr<Engine> Verifier::create(const std::string &name, int width, int height, Rule rule) const
+{
+    // The ltl engine only runs life-like rules with a radius of one, and its
+    // Larger than Life notation has no way to express any but Conway's.
+    if (name == "ltl")
+        return rule == s_conway ? make_engine(s_ltl_conway, width, height, m_threads) : nullptr;
+
+    return make_engine(name, width, height, m_threads);
+}
+
+bool Verifier::verify(const Case &test)
+{
+    GameOfLife reference(create(s_reference, test.width, test.height, test.rule));
+    reference.rule(test.rule);
+    test.setup(reference);
+
+    // The models of the engines still matching the reference.
+    std::vector<std::pair<std::string, std::unique_ptr<GameOfLife>>> models;
+    for (const char *name : s_engines) {
+        std::unique_ptr<Engine> engine = create(name, test.width, test.height, test.rule);
+        if (!engine)
+            continue;
+
+        auto model = std::make_unique<GameOfLife>(std::move(engine));
+        model->rule(test.rule);
+        test.setup(*model);
+        models.emplace_back(name, std::move(model));
+    }
+
+    std::string engines;
+    for (const auto &[name, model] : models)
+        engines += " " + name;
+
+    bool blocked = test.width % 64 == 0;
+    for (int depth : s_depths)
+        engines += blocked ? " blocked/" + std::to_string(depth) : "";
+
+    std::cout << std::left << std::setw(28) << test.name
+              << std::setw(12) << (std::to_string(test.width) + "x" + std::to_string(test.height))
+              << std::right << std::setw(12) << test.generations << " " << engines << "\n";
+
+    bool matched = true;
+    std::vector<Tile> expected;
+    std::vector<Tile> actual;
+
+    // Compare the starting tiles too, which catches engines losing edits.
+    for (std::uint64_t generation = 0; generation <= test.generations && !models.empty(); generation++) {
+
+        if (generation > 0)
+            reference.advance();
+
+        reference.snapshot(expected);
+        std::sort(expected.begin(), expected.end(), before);
+
+        for (auto model = models.begin(); model != models.end();) {
+
+            if (generation > 0)
+                model->second->advance();
+
+            model->second->snapshot(actual);
+            std::sort(actual.begin(), actual.end(), before);
+
+            if (actual == expected) {
+                model++;
+                continue;
+            }
+
+            std::cout << "  " << model->first << " diverged at generation " << generation << "\n";
+            diff(expected, actual, test.width, test.height);
+
+            // Only the first divergence of each engine is reported.
+            matched = false;
+            model = models.erase(model);
+        }
+    }
+
+    for (int depth : s_depths)
+        matched = (!blocked || verify(test, depth)) && matched;
+
+    return matched;
+}
+
+bool Verifier::verify(const Case &test, int depth)
+{
+    GameOfLife reference(create(s_reference, test.width, test.height, test.rule));
+    reference.rule(test.rule);
+    test.setup(reference);
+
+    std::vector<Tile> expected;
+    std::vector<Tile> actual;
+    reference.snapshot(expected);
+
+    BlockedEngine engine(test.width, test.height, depth, m_threads);
+    engine.rule(test.rule);
+
+    for (Tile tile : expected)
+        engine.update(tile.x, tile.y, true);
+
+    for (std::uint64_t generation = 0; generation < test.generations;) {
+
+        std::uint64_t generations = std::min<std::uint64_t>(depth, test.generations - generation);
+        generation += generations;
+
+        engine.run(generations);
+        for (std::uint64_t i = 0; i < generations; i++)
+            reference.advance();
+
+        reference.snapshot(expected);
+        std::sort(expected.begin(), expected.end(), before);
+
+        // Row major, the order tiles are sorted in.
+        actual.clear();
+        for (int y = 0; y < test.height; y++) {
+            for (int x = 0; x < test.width; x++) {
+                if (engine.alive(x, y))
+                    actual.push_back(Tile {x, y});
+            }
+        }
+
+        if (actual != expected) {
+            std::cout << "  blocked/" << depth << " diverged by generation " << generation << "\n";
+            diff(expected, actual, test.width, test.height);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Verifier::stream()
+{
+    using namespace std::chrono;
+
+    GameOfLife served(s_stream_size, s_stream_size);
+    served.add_soup(0.3, 9);
+
+    std::cout << std::left << std::setw(28) << "stream over loopback"
+              << std::setw(12) << (std::to_string(s_stream_size) + "x" + std::to_string(s_stream_size))
+              << std::right << std::setw(12) << s_stream_generations << "  client\n";
+
+    Server server(served, s_stream_port);
+    if (!server.listening())
+        return false;
+
+    // Step like the simulation thread, publishing after each generation, and
+    // keep publishing after the last so a client connecting late still
+    // receives its keyframe.
+    std::jthread stepping([&](std::stop_token stop) {
+        while (!stop.stop_requested()) {
+            if (served.generation() < s_stream_generations)
+                served.advance();
+
+            server.publish();
+            std::this_thread::sleep_for(milliseconds(1));
+        }
+    });
+
+    Client client;
+    if (!client.connect("127.0.0.1", s_stream_port)) {
+        std::cout << "  client failed to connect\n";
+        return false;
+    }
+
+    GameOfLife observed(client.width(), client.height());
+    bool applied = false;
+
+    std::vector<Tile> expected;
+    std::vector<Tile> actual;
+
+    steady_clock::time_point deadline = steady_clock::now() + s_stream_timeout;
+
+    while (client.receive(observed, sf::milliseconds(16), applied) && steady_clock::now() < deadline) {
+        if (client.generation() < s_stream_generations)
+            continue;
+
+        served.snapshot(expected);
+        observed.snapshot(actual);
+        std::sort(expected.begin(), expected.end(), before);
+        std::sort(actual.begin(), actual.end(), before);
+
+        if (actual == expected)
+            return true;
+    }
+
+    if (client.generation() < s_stream_generations || actual == expected) {
+        std::cout << "  client stopped receiving at generation " << client.generation() << "\n";
+        return false;
+    }
+
+    std::cout << "  client diverged at generation " << client.generation() << "\n";
+    diff(expected, actual, s_stream_size, s_stream_size);
+
+    return false;
+}
+
+void Verifier::diff(const std::vector<Tile> &reference, const std::vector<Tile> &tiles, int width, int height)
+{
+    std::vector<Tile> missing;
+    std::vector<Tile> extra;
+
+    std::set_difference(reference.begin(), reference.end(), tiles.begin(), tiles.end(), std::back_inserter(missing), before);
+    std::set_difference(tiles.begin(), tiles.end(), reference.begin(), reference.end(), std::back_inserter(extra), before);
+
+    auto list = [](const char *label, const std::vector<Tile> &differing) {
+        std::cout << "    " << differing.size() << " " << label << ":";
+
+        for (std::size_t i = 0; i < differing.size() && i < s_listed; i++)
+            std::cout << " (" << differing[i].x << "," << differing[i].y << ")";
+
+        if (differing.size() > s_listed)
+            std::cout << " ...";
+
+        std::cout << "\n";
+    };
+
+    list("missing", missing);
+    list("extra", extra);
+
+    // Map the tiles around the first difference, wrapping like the game space.
+    Tile first = missing.empty() || (!extra.empty() && before(extra[0], missing[0])) ? extra[0] : missing[0];
+
+    std::unordered_set<Tile> expected(reference.begin(), reference.end());
+    std::unordered_set<Tile> actual(tiles.begin(), tiles.end());
+
+    std::cout << "    around (" << first.x << "," << first.y << "), o alive in both, - missing, + extra:\n";
+
+    for (int dy = -s_map_radius; dy <= s_map_radius; dy++) {
+        std::cout << "    ";
+
+        for (int dx = -s_map_radius; dx <= s_map_radius; dx++) {
+            Tile tile {
+                ((first.x + dx) % width + width) % width,
+                ((first.y + dy) % height + height) % height
+            };
+
+            bool in_reference = expected.count(tile);
+            bool in_engine = actual.count(tile);
+
+            std::cout << (in_reference && in_engine ? 'o' : in_reference ? '-' : in_engine ? '+' : '.');
+        }
+
+        std::cout << "\n";
+    }
+}
+
+bool Verifier::throughput()
+{
+    using namespace std::chrono;
+
+    std::map<std::string, double> baseline;
+    bool recording = m_record || !read_baseline(m_baseline, baseline);
+
+    std::cout << "Throughput on a " << s_throughput_size << "x" << s_throughput_size << " soup, "
+              << (recording ? "recording" : "compared with") << " " << m_baseline << "\n"
+              << std::left << std::setw(14) << "Engine"
+              << std::right << std::setw(16) << "Baseline" << std::setw(16) << "Generations/s" << std::setw(10) << "Change" << "\n";
+
+    std::map<std::string, double> rates;
+    bool fast = true;
+    bool added = false;
+
+    std::vector<std::string> names = {s_reference};
+    names.insert(names.end(), std::begin(s_engines), std::end(s_engines));
+
+    for (const std::string &name : names) {
+
+        // The best of a few rounds, each from the same soup, as a busy machine
+        // only ever makes an engine slower.
+        double rate = 0;
+
+        for (int round = 0; round < s_rounds; round++) {
+
+            std::unique_ptr<Engine> engine = create(name, s_throughput_size, s_throughput_size, s_conway);
+            if (!engine)
+                break;
+
+            // The same soup as GameOfLife::add_soup().
+            std::mt19937 generator(1);
+            std::bernoulli_distribution alive(0.3);
+            for (int y = 0; y < s_throughput_size; y++) {
+                for (int x = 0; x < s_throughput_size; x++) {
+                    if (alive(generator))
+                        engine->update(x, y, true);
+                }
+            }
+
+            std::vector<Tile> born;
+            std::vector<Tile> died;
+            std::uint64_t generations = 0;
+
+            steady_clock::time_point start = steady_clock::now();
+            steady_clock::duration elapsed;
+
+            do {
+                born.clear();
+                died.clear();
+                engine->advance(born, died);
+                generations++;
+                elapsed = steady_clock::now() - start;
+            }
+            while (elapsed < s_budget);
+
+            rate = std::max(rate, generations / duration_cast<duration<double>>(elapsed).count());
+        }
+
+        if (rate == 0)
+            continue;
+
+        rates[name] = rate;
+
+        std::cout << std::left << std::setw(14) << name << std::right << std::setprecision(1);
+
+        auto found = baseline.find(name);
+        if (recording) {
+            std::cout << std::setw(16) << "-" << std::setw(16) << rate << "\n";
+            continue;
+        }
+
+        // Engines added since the baseline was recorded join it, so they are
+        // guarded from the next run on.
+        if (found == baseline.end()) {
+            baseline[name] = rate;
+            added = true;
+            std::cout << std::setw(16) << "-" << std::setw(16) << rate << "  added\n";
+            continue;
+        }
+
+        double change = 100 * (rate / found->second - 1);
+        bool regressed = change < -m_threshold;
+        fast = fast && !regressed;
+
+        std::cout << std::setw(16) << found->second << std::setw(16) << rate
+                  << std::setw(9) << std::showpos << change << std::noshowpos << "%"
+                  << (regressed ? "  regressed" : "") << "\n";
+    }
+
+    if ((recording || added) && !write_baseline(m_baseline, recording ? rates : baseline)) {
+        std::cerr << "Failed to write the baseline " << m_baseline << ".\n";
+        return false;
+    }
+
+    return fast;
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "GameOfLife.hpp"
+#include "Options.hpp"
+
+/**
+ * @brief Verifies that every engine steps exactly like the sparse engine, the
+ * reference implementation, and that none has become slower than a stored
+ * baseline.
+ * 
+ * Each case starts every available engine from the same random soup or
+ * patterns, including patterns crossing the edges where the game space wraps,
+ * and compares the alive tiles of every engine with the reference after every
+ * generation. The first generation an engine diverges at is reported with the
+ * tiles that differ and a map around the first of them. The blocked engine is
+ * also run in passes of several depths, and compared after every pass. A game
+ * stepped while served over loopback is compared with a client observing it.
+ * 
+ * The baseline is a JSON object of the generations per second of each engine
+ * on a fixed soup. An engine regresses if it is slower than its baseline by
+ * more than the threshold.
+ */
+class Verifier
+{
+public:
+
+    /**
+     * @brief Create the verifier described by the options.
+     * @param options The command line options.
+     */
+    Verifier(const Options &options);
+
+    /**
+     * @brief Run every case and the throughput comparison, and print the
+     * results.
+     * @return Zero if no engine diverged or regressed, otherwise one.
+     */
+    int run();
+
+private:
+
+    /// A starting state and rule every engine is run from.
+    struct Case {
+
+        /// The name printed with the results.
+        std::string name;
+
+        /// The size of the game space.
+        int width;
+        int height;
+
+        /// The rule.
+        Rule rule;
+
+        /// The number of generations to compare.
+        std::uint64_t generations;
+
+        /// Sets the starting tiles.
+        std::function<void(GameOfLife&)> setup;
+    };
+
+    /**
+     * @brief Get every case.
+     * @return The cases.
+     */
+    std::vector<Case> cases() const;
+
+    /**
+     * @brief Create an engine by name, including the ltl engine running
+     * Conway's rule.
+     * 
+     * @param name The name of the engine.
+     * @param width The width of the grid in tiles.
+     * @param height The height of the grid in tiles.
+     * @param rule The rule the engine must run.
+     * @return The engine, or null if it is not available for the size or
+     * rule.
+     */
+    std::unique_ptr<Engine> create(const std::string &name, int width, int height, Rule rule) const;
+
+    /**
+     * @brief Run every engine on a case, comparing with the reference.
+     * 
+     * @param test The case.
+     * @return If every engine matched the reference.
+     */
+    bool verify(const Case &test);
+
+    /**
+     * @brief Run the blocked engine on a case in passes of a depth, comparing
+     * with the reference after every pass.
+     * 
+     * @param test The case, whose width is a multiple of 64.
+     * @param depth The generations of each pass.
+     * @return If the engine matched the reference.
+     */
+    bool verify(const Case &test, int depth);
+
+    /**
+     * @brief Step a game while serving it over loopback, and compare it with
+     * the game of a client observing it once the client has received the
+     * last generation.
+     * 
+     * @return If the client's game matched the served game.
+     */
+    bool stream();
+
+    /**
+     * @brief Print the tiles that differ between an engine and the reference,
+     * and a map of the tiles around the first.
+     * 
+     * @param reference The alive tiles of the reference, sorted.
+     * @param tiles The alive tiles of the engine, sorted.
+     * @param width The width of the game space.
+     * @param height The height of the game space.
+     */
+    void diff(const std::vector<Tile> &reference, const std::vector<Tile> &tiles, int width, int height);
+
+    /**
+     * @brief Measure the throughput of every engine and compare it with the
+     * baseline, or record the baseline if it does not exist or recording.
+     * Engines missing from the baseline are added to it.
+     * 
+     * @return If no engine regressed.
+     */
+    bool throughput();
+
+    /// The JSON file of the baseline throughput.
+    std::string m_baseline;
+
+    /// The largest slowdown from the baseline allowed, in percent.
+    double m_threshold;
+
+    /// If the measured throughput replaces the baseline.
+    bool m_record;
+
+    /// The number of workers of engines that have them.
+    std::size_t m_threads;
+};
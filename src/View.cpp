@@ -11,58 +11,45 @@ sf::Color View::s_colour_alive = sf::Color(0xFFFFFFFF);
 sf::Color View::s_colour_dead = sf::Color(0x090909FF);
 sf::Color View::s_colour_background = sf::Color(0x000000FF);
 
-/**
- * @brief A thread must set the window to active in order to render and display.
- * This class locks a window with a given mutex in RAII.
- */
-class WindowLock
-{
-public:
-
-    /**
-     * @brief Lock a window and set this thread to the active OpenGL target.
-     * 
-     * @param window Reference to the window.
-     * @param mutex Reference to the mutex protecting the window.
-     */
-    WindowLock(sf::RenderWindow &window, std::mutex &mutex)
-        : m_window(&window)
-        , m_mutex(&mutex)
-    {
-        m_mutex->lock();
-        m_window->setActive(true);
-    }
-
-    /**
-     * @brief Unset the active thread and unlock the mutex protecting the
-     * window.
-     */
-    ~WindowLock() {
-        m_window->setActive(false);
-        m_mutex->unlock();
-    }
-
-private:
+namespace {
 
-    // Pointer to the window being locked.
-    sf::RenderWindow *m_window;
+/// The key of a page in the kept pages.
+std::uint64_t page_key(int level, int x, int y)
+{
+    return (std::uint64_t(level) << 58) | (std::uint64_t(x) << 29) | std::uint64_t(y);
+}
 
-    // Pointer to the mutex protecting the window.
-    std::mutex *m_mutex;
-};
+}
 
 View::View()
     : m_window()
-    , m_texture()
+    , m_pages()
+    , m_resident()
+    , m_template()
+    , m_template_level(-1)
+    , m_sprite()
+    , m_level(0)
+    , m_page_left(0)
+    , m_page_top(0)
+    , m_page_right(0)
+    , m_page_bottom(0)
+    , m_updates(0)
     , m_view()
     , m_tile_width(0)
     , m_tile_height(0)
     , m_pixel_width(0)
     , m_pixel_height(0)
+    , m_viewport_x(0)
+    , m_viewport_y(0)
+    , m_viewport_width(0)
+    , m_viewport_height(0)
+    , m_centre_x(0)
+    , m_centre_y(0)
+    , m_size_x(0)
+    , m_size_y(0)
+    , m_commands()
     , m_moving(0, 0)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-
     // Get the largest fullscreen mode.
     std::vector<sf::VideoMode> modes = sf::VideoMode::getFullscreenModes();
     auto mode = std::max_element(
@@ -90,145 +77,452 @@ View::View()
 
 View::~View()
 {
-    WindowLock window_lock(*m_window, m_mutex);
     m_window->close();
 }
 
 void View::set(int tile_width, int tile_height)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    post(Command {Command::Type::SET, tile_width, tile_height, false});
+}
 
-    m_tile_width = tile_width;
-    m_tile_height = tile_height;
+bool View::edit(int x, int y, bool alive, std::chrono::steady_clock::time_point time)
+{
+    return post(Command {Command::Type::EDIT, x, y, alive, time});
+}
 
-    // Each tile has s_padding on all four sides, plus the tile inside of
-    // width and height s_tile_size.
-    m_texture.create(
-        (2 * s_padding + s_tile_size) * tile_width + 3 * s_padding,
-        (2 * s_padding + s_tile_size) * tile_height + 3 * s_padding
-    );
+void View::zoom(ZoomAction action)
+{
+    post(Command {Command::Type::ZOOM, 0, 0, action == ZoomAction::IN});
+}
 
-    // Drawing a texture flips it along the top of the screen, flip it back.
-    m_sprite.setScale(1.0, 1.0);
+void View::pan_horisontal(MoveAction action)
+{
+    int x = action == MoveAction::FORWARD ? 1 : action == MoveAction::BACKWARD ? -1 : 0;
+    post(Command {Command::Type::PAN, x, 0, true});
+}
+
+void View::pan_vertical(MoveAction action)
+{
+    int y = action == MoveAction::FORWARD ? -1 : action == MoveAction::BACKWARD ? 1 : 0;
+    post(Command {Command::Type::PAN, 0, y, false});
+}
 
-    // Set the dimensions of the view to match the window.
-    m_view.setSize(m_window->getSize().x, m_window->getSize().y);
+void View::resize(int width, int height)
+{
+    post(Command {Command::Type::RESIZE, width, height, false});
+}
+
+void View::acquire()
+{
+    m_window->setActive(true);
+
+    // Block in display() until the next vertical blank, so frames are never
+    // drawn faster than the screen shows them.
+    m_window->setVerticalSyncEnabled(true);
+}
+
+void View::release()
+{
+    m_window->setActive(false);
+}
 
-    // Center the view on the middle of the texture.
-    sf::Vector2u texture_size = m_texture.getSize();
-    m_view.setCenter(texture_size.x / 2, texture_size.y / 2);
+void View::process(std::vector<std::chrono::steady_clock::time_point> &edits)
+{
+    while (Command *command = m_commands.read_slot()) {
+
+        switch (command->type) {
+        case Command::Type::SET:
+            m_tile_width = command->x;
+            m_tile_height = command->y;
+
+            // Every page is of the old game space.
+            m_resident.clear();
+            for (std::unique_ptr<Page> &page : m_pages)
+                page->used = 0;
+
+            {
+                // Each tile has s_padding on all four sides, plus the tile
+                // inside of width and height s_tile_size.
+                int world_width = (2 * s_padding + s_tile_size) * m_tile_width + 3 * s_padding;
+                int world_height = (2 * s_padding + s_tile_size) * m_tile_height + 3 * s_padding;
+
+                // Set the dimensions of the view to match the window, centred
+                // on the middle of the game space.
+                m_view.setSize(m_window->getSize().x, m_window->getSize().y);
+                m_view.setCenter(world_width / 2, world_height / 2);
+
+                // Zoom in so the width is the same as the game space.
+                m_view.zoom((float)world_width / (float)m_window->getSize().x);
+            }
+            break;
+
+        case Command::Type::EDIT:
+            draw(command->x, command->y, command->value ? s_colour_alive : s_colour_dead);
+            edits.push_back(command->time);
+            break;
+
+        case Command::Type::ZOOM:
+            m_view.zoom(command->value ? 1.1 : 0.9);
+            break;
+
+        case Command::Type::PAN:
+            // The value is set when panning horisontally.
+            if (command->value)
+                m_moving.x = command->x;
+            else
+                m_moving.y = command->y;
+            break;
+
+        case Command::Type::RESIZE:
+            // Keep the same texture pixels per window pixel.
+            m_view.setSize(
+                m_view.getSize().x * command->x / m_pixel_width,
+                m_view.getSize().y * command->y / m_pixel_height
+            );
+
+            m_pixel_width = command->x;
+            m_pixel_height = command->y;
+            break;
+        }
 
-    // Zoom in so the width is the same as the texture.
-    m_view.zoom((float)texture_size.x / (float)m_window->getSize().x);
+        m_commands.pop();
+    }
 
+    // Also displays the pages drawn by edits.
     m_window->setView(m_view);
+    update_viewport();
 }
 
-void View::render(std::unordered_set<Tile> tiles)
+void View::render(Region region, const std::vector<Tile> &tiles)
 {
-    WindowLock lock(*m_window, m_mutex);
+    int span = s_page_tiles << m_level;
 
-    // Create a square for rendering.
-    sf::RectangleShape square;
-    square.setSize(sf::Vector2f(s_tile_size, s_tile_size));
+    // Only pages entirely inside the region are redrawn, the rest keep their
+    // tiles until a frame covers them.
+    for (auto &[key, page] : m_resident) {
 
-    for (int x = 0; x < m_tile_width; x++) {
-        for (int y = 0; y < m_tile_height; y++) {
+        if (page->level != m_level)
+            continue;
 
-            square.setPosition(sf::Vector2f(
-                (2 * x * s_padding) + (s_tile_size * x + s_tile_size / 2),
-                (2 * y * s_padding) + (s_tile_size * y + s_tile_size / 2)
-            ));
+        int left = page->x * span;
+        int top = page->y * span;
+        int right = std::min(left + span, m_tile_width);
+        int bottom = std::min(top + span, m_tile_height);
 
-            if (tiles.contains(Tile(x, y))) {
-                square.setFillColor(s_colour_alive);
-            }
-            else {
-                square.setFillColor(s_colour_dead);
-            }
+        page->covered = left >= region.x && top >= region.y
+            && right <= region.x + region.width && bottom <= region.y + region.height;
 
-            m_texture.draw(square);
-        }
+        if (page->covered)
+            page->vertices.clear();
     }
 
-    m_texture.display();
-}
+    // Batch the alive tiles of each page into one draw.
+    Page *current = nullptr;
+    for (Tile tile : tiles) {
 
-void View::render(int x, int y, bool value)
-{
-    WindowLock lock(*m_window, m_mutex);
+        int x = tile.x / span;
+        int y = tile.y / span;
 
-    // Create a new square and set it at the position (x, y)
-    sf::RectangleShape square(sf::Vector2f(s_tile_size, s_tile_size));
-    square.setPosition(sf::Vector2f(
-        (2 * x * s_padding) + (s_tile_size * x + s_tile_size / 2),
-        (2 * y * s_padding) + (s_tile_size * y + s_tile_size / 2)
-    ));
+        if (!current || current->x != x || current->y != y)
+            current = find(m_level, x, y);
+
+        if (current && current->covered)
+            append(current->vertices, m_level, tile.x - x * span, tile.y - y * span, s_colour_alive);
+    }
 
-    // Change it's colour depending on the tile state.
-    value ? square.setFillColor(s_colour_alive)
-          : square.setFillColor(s_colour_dead);
+    for (auto &[key, page] : m_resident) {
+        if (!page->covered)
+            continue;
 
-    // Change the square colour on the texture.
-    m_texture.draw(square);
+        reset(*page);
+        page->texture.draw(page->vertices);
+        page->covered = false;
+    }
 
-    m_texture.display();
+    flush();
 }
 
 void View::display()
 {
-    WindowLock window_lock(*m_window, m_mutex);
-
-    // Update the view.
+    // Update the view, keeping the pages it now covers.
     m_view.setCenter(m_view.getCenter() + m_moving);
     m_window->setView(m_view);
+    update_viewport();
 
     m_window->clear(s_colour_background);
 
-    // Draw the sprite, that handles transformations of the texture.
-    m_sprite.setTexture(m_texture.getTexture());
+    // Each page texel covers two to the level pixels of the world space.
+    float scale = 1 << m_level;
+    float extent = page_pixels() * scale;
+
+    m_sprite.setScale(scale, scale);
+
+    for (int y = m_page_top; y < m_page_bottom; y++) {
+        for (int x = m_page_left; x < m_page_right; x++) {
+
+            Page *page = find(m_level, x, y);
+            if (!page)
+                continue;
+
+            m_sprite.setTexture(page->texture.getTexture(), true);
+            m_sprite.setPosition(x * extent, y * extent);
+            m_window->draw(m_sprite);
+        }
+    }
 
-    // Display it in the window.
-    m_window->draw(m_sprite);
     m_window->display();
 }
 
-void View::zoom(ZoomAction action)
+sf::Vector2i View::map_pixel_to_tile(int x, int y) const
 {
-    if (action == ZoomAction::IN)
-        m_view.zoom(1.1);
-    else
-        m_view.zoom(0.9);
+    // The view covers the whole window without rotation, so a pixel maps
+    // linearly onto the view's rectangle of the texture.
+    float world_x = m_centre_x + (float(x) / m_pixel_width - 0.5f) * m_size_x;
+    float world_y = m_centre_y + (float(y) / m_pixel_height - 0.5f) * m_size_y;
 
-    WindowLock window_lock(*m_window, m_mutex);
-    m_window->setView(m_view);
+    int tile_x = std::floor(world_x / (2 * s_padding + s_tile_size));
+    int tile_y = std::floor(world_y / (2 * s_padding + s_tile_size));
+
+    return sf::Vector2i(tile_x, tile_y);
 }
 
-void View::pan_horisontal(MoveAction action)
+Region View::viewport() const
 {
-    if (action == MoveAction::FORWARD)
-        m_moving.x = 1;
-    else if (action == MoveAction::BACKWARD)
-        m_moving.x = -1;
-    else
-        m_moving.x = 0;
+    return Region(
+        m_viewport_x.load(std::memory_order_relaxed),
+        m_viewport_y.load(std::memory_order_relaxed),
+        m_viewport_width.load(std::memory_order_relaxed),
+        m_viewport_height.load(std::memory_order_relaxed)
+    );
 }
 
-void View::pan_vertical(MoveAction action)
+bool View::post(const Command &command)
 {
-    if (action == MoveAction::FORWARD)
-        m_moving.y = -1;
-    else if (action == MoveAction::BACKWARD)
-        m_moving.y = 1;
-    else
-        m_moving.y = 0;
+    Command *slot = m_commands.write_slot();
+    if (!slot)
+        return false;
+
+    *slot = command;
+    m_commands.push();
+    return true;
 }
 
-sf::Vector2i View::map_pixel_to_tile(int x, int y) const
+void View::draw(int x, int y, const sf::Color &colour)
 {
-    sf::Vector2f world_position = m_window->mapPixelToCoords(sf::Vector2i(x, y));
-    int tile_x = std::floor(world_position.x / (2 * s_padding + s_tile_size));
-    int tile_y = std::floor(world_position.y / (2 * s_padding + s_tile_size));
+    if (x < 0 || y < 0 || x >= m_tile_width || y >= m_tile_height)
+        return;
 
-    return sf::Vector2i(tile_x, tile_y);
+    int span = s_page_tiles << m_level;
+
+    // A page that is not kept is drawn by the frame that covers it.
+    Page *page = find(m_level, x / span, y / span);
+    if (!page)
+        return;
+
+    sf::VertexArray quad(sf::Quads);
+    append(quad, m_level, x - page->x * span, y - page->y * span, colour);
+
+    page->texture.draw(quad);
+    page->dirty = true;
+}
+
+void View::append(sf::VertexArray &vertices, int level, int x, int y, const sf::Color &colour)
+{
+    // Each level halves the resolution, but a tile always covers a pixel.
+    float scale = 1.0f / (1 << level);
+    float left = ((2 * x * s_padding) + (s_tile_size * x + s_tile_size / 2)) * scale;
+    float top = ((2 * y * s_padding) + (s_tile_size * y + s_tile_size / 2)) * scale;
+    float size = std::max(1.0f, s_tile_size * scale);
+
+    vertices.append(sf::Vertex(sf::Vector2f(left, top), colour));
+    vertices.append(sf::Vertex(sf::Vector2f(left + size, top), colour));
+    vertices.append(sf::Vertex(sf::Vector2f(left + size, top + size), colour));
+    vertices.append(sf::Vertex(sf::Vector2f(left, top + size), colour));
+}
+
+View::Page *View::find(int level, int x, int y)
+{
+    auto found = m_resident.find(page_key(level, x, y));
+    return found == m_resident.end() ? nullptr : found->second;
+}
+
+View::Page *View::page(int level, int x, int y)
+{
+    if (Page *page = find(level, x, y))
+        return page;
+
+    // Reuse a free page, or the least recently used page not kept by this
+    // update. The pool is only ever short of pages if rounding lets one more
+    // page into the view than capacity() allows for.
+    Page *page = nullptr;
+    if (m_pages.size() >= capacity()) {
+        for (std::unique_ptr<Page> &candidate : m_pages) {
+            if (candidate->used < m_updates && (!page || candidate->used < page->used))
+                page = candidate.get();
+        }
+    }
+
+    if (page) {
+        auto kept = m_resident.find(page_key(page->level, page->x, page->y));
+        if (kept != m_resident.end() && kept->second == page)
+            m_resident.erase(kept);
+    }
+    else {
+        m_pages.push_back(std::make_unique<Page>());
+        page = m_pages.back().get();
+        page->texture.create(page_pixels(), page_pixels());
+        page->vertices.setPrimitiveType(sf::Quads);
+    }
+
+    page->level = level;
+    page->x = x;
+    page->y = y;
+    page->covered = false;
+    m_resident[page_key(level, x, y)] = page;
+
+    reset(*page);
+    return page;
+}
+
+void View::reset(Page &page)
+{
+    int pixels = page_pixels();
+    int span = s_page_tiles << page.level;
+
+    // Draw the template of dead tiles once per level of detail.
+    if (m_template_level != page.level) {
+
+        if (m_template_level < 0)
+            m_template.create(pixels, pixels);
+
+        m_template.clear(s_colour_background);
+
+        // Tiles less than two pixels apart leave no visible gap between them.
+        if ((2 * s_padding + s_tile_size) >> page.level >= 2) {
+            sf::VertexArray quads(sf::Quads);
+            for (int y = 0; y < span; y++) {
+                for (int x = 0; x < span; x++) {
+                    append(quads, page.level, x, y, s_colour_dead);
+                }
+            }
+            m_template.draw(quads);
+        }
+        else {
+            sf::RectangleShape fill(sf::Vector2f(pixels, pixels));
+            fill.setFillColor(s_colour_dead);
+            m_template.draw(fill);
+        }
+
+        m_template.display();
+        m_template_level = page.level;
+    }
+
+    // Only the part of the page inside the game space has tiles.
+    int columns = std::min(span, m_tile_width - page.x * span);
+    int rows = std::min(span, m_tile_height - page.y * span);
+
+    sf::Sprite sprite(m_template.getTexture());
+    sprite.setTextureRect(sf::IntRect(
+        0,
+        0,
+        std::min(pixels, int(std::ceil(float((2 * s_padding + s_tile_size) * columns) / (1 << page.level)))),
+        std::min(pixels, int(std::ceil(float((2 * s_padding + s_tile_size) * rows) / (1 << page.level))))
+    ));
+
+    page.texture.clear(s_colour_background);
+    page.texture.draw(sprite);
+    page.dirty = true;
+}
+
+void View::flush()
+{
+    for (auto &[key, page] : m_resident) {
+        if (page->dirty) {
+            page->texture.display();
+            page->dirty = false;
+        }
+    }
+}
+
+std::size_t View::capacity() const
+{
+    // A page texel covers one to two pixels of the screen, and the pages
+    // partially in view add one across and down, then the margin a ring.
+    int pixels = page_pixels();
+    std::size_t across = (2 * m_pixel_width + pixels - 1) / pixels + 1 + 2 * s_page_margin;
+    std::size_t down = (2 * m_pixel_height + pixels - 1) / pixels + 1 + 2 * s_page_margin;
+
+    return across * down;
+}
+
+int View::page_pixels() const
+{
+    return (2 * s_padding + s_tile_size) * s_page_tiles;
+}
+
+void View::update_viewport()
+{
+    sf::Vector2f centre = m_view.getCenter();
+    sf::Vector2f size = m_view.getSize();
+    float stride = 2 * s_padding + s_tile_size;
+
+    m_centre_x.store(centre.x, std::memory_order_relaxed);
+    m_centre_y.store(centre.y, std::memory_order_relaxed);
+    m_size_x.store(size.x, std::memory_order_relaxed);
+    m_size_y.store(size.y, std::memory_order_relaxed);
+
+    // Tiles partially inside the view are included.
+    float left = (centre.x - size.x / 2) / stride;
+    float top = (centre.y - size.y / 2) / stride;
+    float right = (centre.x + size.x / 2) / stride;
+    float bottom = (centre.y + size.y / 2) / stride;
+
+    // The finest level of detail where a page texel covers at least one
+    // pixel of the screen, so the pages in view never outnumber the screen.
+    float texels = m_pixel_width > 0 ? size.x / m_pixel_width : 1;
+    int level = 0;
+    while (texels >= 2 && level < s_page_levels) {
+        texels /= 2;
+        level++;
+    }
+
+    int span = s_page_tiles << level;
+    int pages_x = (m_tile_width + span - 1) / span;
+    int pages_y = (m_tile_height + span - 1) / span;
+
+    m_level = level;
+    m_page_left = std::clamp(int(std::floor(left / span)) - s_page_margin, 0, pages_x);
+    m_page_top = std::clamp(int(std::floor(top / span)) - s_page_margin, 0, pages_y);
+    m_page_right = std::clamp(int(std::ceil(right / span)) + s_page_margin, m_page_left, pages_x);
+    m_page_bottom = std::clamp(int(std::ceil(bottom / span)) + s_page_margin, m_page_top, pages_y);
+
+    // Keep every page in range, drawing new pages dead until a frame covers
+    // them. Pages already kept are marked first so none are evicted for
+    // another page in range.
+    m_updates++;
+    for (int y = m_page_top; y < m_page_bottom; y++) {
+        for (int x = m_page_left; x < m_page_right; x++) {
+            if (Page *kept = find(m_level, x, y))
+                kept->used = m_updates;
+        }
+    }
+
+    for (int y = m_page_top; y < m_page_bottom; y++) {
+        for (int x = m_page_left; x < m_page_right; x++) {
+            page(m_level, x, y)->used = m_updates;
+        }
+    }
+
+    flush();
+
+    // Frames cover every kept page.
+    int region_left = m_page_left * span;
+    int region_top = m_page_top * span;
+    int region_right = std::min(m_page_right * span, m_tile_width);
+    int region_bottom = std::min(m_page_bottom * span, m_tile_height);
+
+    m_viewport_x.store(region_left, std::memory_order_relaxed);
+    m_viewport_y.store(region_top, std::memory_order_relaxed);
+    m_viewport_width.store(std::max(0, region_right - region_left), std::memory_order_relaxed);
+    m_viewport_height.store(std::max(0, region_bottom - region_top), std::memory_order_relaxed);
 }
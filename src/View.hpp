@@ -1,15 +1,29 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <memory>
-#include <mutex>
 #include <SFML/Graphics.hpp>
+#include <unordered_map>
+#include <vector>
 
 #include "GameOfLife.hpp"
+#include "RingBuffer.hpp"
 
 /**
  * @brief The view is responsible for rendering, updating the screen and getting
  * user input from the window.
+ * 
+ * Only one render thread ever draws, and it keeps the window's OpenGL context
+ * active for its whole life. Other threads change the view by posting commands
+ * to a lock free queue that the render thread drains once per frame, so they
+ * never wait for rendering and the context never switches threads.
+ * 
+ * The game space is split into square pages, each rasterised into its own
+ * small texture. Only the pages covering the view plus a margin are kept, in a
+ * pool sized by the screen, so any size of game space fits in the GPU's
+ * largest texture and in bounded memory. Zoomed out, pages cover more tiles at
+ * a lower level of detail, so the screen never needs more pages.
  */
 class View
 {
@@ -27,6 +41,19 @@ public:
      */
     ~View();
 
+    /// States for zooming.
+    enum class ZoomAction {
+        IN,
+        OUT
+    };
+
+    /// States of horisontal and vertical panning.
+    enum class MoveAction {
+        STAY,
+        FORWARD,
+        BACKWARD
+    };
+
     /**
      * @brief Set the game of life space width and height. Rendering will assume
      * these dimensions when updating tile states.
@@ -37,29 +64,90 @@ public:
     void set(int tile_width, int tile_height);
 
     /**
-     * @brief Renders all given tiles.
-     * @param tiles The set of alive tiles.
-     */
-    void render(std::unordered_set<Tile> tiles);
-
-    /**
-     * @brief Updates a tile at position (x, y).
+     * @brief Updates a tile at position (x, y) ahead of the next frame.
      * 
      * @param x The x coordinate of the tile.
      * @param y The y coordinate of the tile.
      * @param alive If the tile is alive.
+     * @param time When the edit was made, to measure the time until it is
+     * shown.
+     * @return If the edit was posted, otherwise the queue is full and the tile
+     * is only updated by the next frame of its region.
+     */
+    bool edit(int x, int y, bool alive, std::chrono::steady_clock::time_point time);
+
+    /**
+     * @brief Zoom the view in or out.
+     * @param zoom The zoom action to perform.
+     */
+    void zoom(ZoomAction zoom);
+
+    /**
+     * @brief Set the panning state horisontally.
+     * @param action Whether to say, increase or decrease the horisontal pan.
      */
-    void render(int x, int y, bool alive);
+    void pan_horisontal(MoveAction action);
+
+    /**
+     * @brief Set the panning state vertically.
+     * @param action Whether to say, increase or decrease the vertically pan.
+     */
+    void pan_vertical(MoveAction action);
+
+    /**
+     * @brief Resize the view to a new window size, keeping the zoom.
+     * 
+     * @param width The pixel width of the window.
+     * @param height The pixel height of the window.
+     */
+    void resize(int width, int height);
+
+    /**
+     * @brief Make the window's OpenGL context active on the calling thread,
+     * which becomes the render thread, and pace its display() by vsync.
+     */
+    void acquire();
+
+    /**
+     * @brief Release the window's OpenGL context from the render thread.
+     */
+    void release();
+
+    /**
+     * @brief Apply every posted command. Only called by the render thread.
+     * 
+     * @param edits Appended with the time each applied edit was made.
+     */
+    void process(std::vector<std::chrono::steady_clock::time_point> &edits);
+
+    /**
+     * @brief Renders a region of tiles, where only the given tiles are alive.
+     * Only called by the render thread.
+     * 
+     * @param region The region of tiles to redraw.
+     * @param tiles The alive tiles inside the region.
+     */
+    void render(Region region, const std::vector<Tile> &tiles);
 
     /**
      * @brief Updates the display to the screen, transforming everything
      * rendered to the current texture depending on view position and updating
-     * the screen.
+     * the screen. Only called by the render thread.
      */
     void display();
 
     /**
-     * @brief Get a reference to the rendering window.
+     * @brief Get if the view is panning, so every frame moves the camera.
+     * Only called by the render thread.
+     * 
+     * @return If the view is panning.
+     */
+    inline bool moving() const {
+        return m_moving.x != 0 || m_moving.y != 0;
+    }
+
+    /**
+     * @brief Get a reference to the rendering window, only for its events.
      * @return A reference to the rendering window.
      */
     inline sf::RenderWindow &window() {
@@ -82,65 +170,198 @@ public:
         return m_pixel_height;
     }
 
-    /// States for zooming.
-    enum class ZoomAction {
-        IN,
-        OUT
+    /**
+     * @brief Get the game space tile coordinates from pixel coordinates, as of
+     * the last frame.
+     * 
+     * @param x The pixel x position.
+     * @param y The pixel y position.
+     * 
+     * @return The (x, y) game space tile mapped to the pixel.
+     */
+    sf::Vector2i map_pixel_to_tile(int x, int y) const;
+
+    /**
+     * @brief Get the region of game space tiles of the pages visible through
+     * the view and their margin, clipped to the game space. Frames of this
+     * region redraw every page they cover. Safe to call from any thread
+     * without blocking rendering.
+     * 
+     * @return The region of tiles of the kept pages.
+     */
+    Region viewport() const;
+
+private:
+
+    /// A change to the view posted to the render thread.
+    struct Command {
+
+        /// The kinds of change.
+        enum class Type {
+            SET,
+            EDIT,
+            ZOOM,
+            PAN,
+            RESIZE
+        };
+
+        /// The kind of change.
+        Type type;
+
+        /// The tile of an edit, the size of a set or a resize, or the pan
+        /// direction of each axis.
+        int x;
+        int y;
+
+        /// If an edited tile is alive, if zooming in, or if panning
+        /// horisontally rather than vertically.
+        bool value;
+
+        /// When an edit was made.
+        std::chrono::steady_clock::time_point time = {};
     };
 
-    /// States of horisontal and vertical panning.
-    enum class MoveAction {
-        STAY,
-        FORWARD,
-        BACKWARD
+    /**
+     * @brief Post a command to the render thread.
+     * 
+     * @param command The command.
+     * @return If the command was posted, otherwise the queue is full.
+     */
+    bool post(const Command &command);
+
+    /// A square of the game space rasterised into its own texture.
+    struct Page {
+
+        /// The pixels of the page.
+        sf::RenderTexture texture;
+
+        /// The level of detail, each level covering twice the tiles across at
+        /// half the resolution.
+        int level;
+
+        /// The page coordinates at its level.
+        int x;
+        int y;
+
+        /// The viewport update that last kept the page, to evict the least
+        /// recently used.
+        std::uint64_t used;
+
+        /// If drawn to since the texture was last displayed.
+        bool dirty;
+
+        /// If the frame being rendered covers the page.
+        bool covered;
+
+        /// The alive tiles of the frame being rendered.
+        sf::VertexArray vertices;
     };
 
     /**
-     * @brief Zoom the view in or out.
-     * @param zoom The zoom action to perform.
+     * @brief Draw a tile onto its page, if the page is kept.
+     * 
+     * @param x The x coordinate of the tile.
+     * @param y The y coordinate of the tile.
+     * @param colour The colour of the tile.
      */
-    void zoom(ZoomAction zoom);
+    void draw(int x, int y, const sf::Color &colour);
 
     /**
-     * @brief Set the panning state horisontally.
-     * @param action Whether to say, increase or decrease the horisontal pan.
+     * @brief Append the quad of a tile to draw onto a page.
+     * 
+     * @param vertices The quads to append to.
+     * @param level The level of detail of the page.
+     * @param x The x coordinate of the tile within the page.
+     * @param y The y coordinate of the tile within the page.
+     * @param colour The colour of the tile.
      */
-    void pan_horisontal(MoveAction action);
+    void append(sf::VertexArray &vertices, int level, int x, int y, const sf::Color &colour);
 
     /**
-     * @brief Set the panning state vertically.
-     * @param action Whether to say, increase or decrease the vertically pan.
+     * @brief Get a kept page.
+     * 
+     * @param level The level of detail.
+     * @param x The page x coordinate at the level.
+     * @param y The page y coordinate at the level.
+     * @return The page, or nullptr if it is not kept.
      */
-    void pan_vertical(MoveAction action);
+    Page *find(int level, int x, int y);
 
     /**
-     * @brief Get the game space tile coordinates from pixel coordinates.
+     * @brief Get a kept page, making it from a free or the least recently used
+     * page if it is not kept. A new page shows dead tiles until a frame
+     * covers it.
      * 
-     * @param x The pixel x position.
-     * @param y The pixel y position.
+     * @param level The level of detail.
+     * @param x The page x coordinate at the level.
+     * @param y The page y coordinate at the level.
+     * @return The page.
+     */
+    Page *page(int level, int x, int y);
+
+    /**
+     * @brief Draw every tile of a page inside the game space dead.
+     * @param page The page.
+     */
+    void reset(Page &page);
+
+    /**
+     * @brief Display every page drawn to since it was last displayed.
+     */
+    void flush();
+
+    /**
+     * @brief Get the number of pages the pool may hold, enough to cover the
+     * screen and the margin at any zoom.
      * 
-     * @return The (x, y) game space tile mapped to the pixel.
+     * @return The number of pages.
      */
-    sf::Vector2i map_pixel_to_tile(int x, int y) const;
+    std::size_t capacity() const;
 
-private:
+    /**
+     * @brief Get the pixel width and height of a page texture.
+     * @return The pixel width and height.
+     */
+    int page_pixels() const;
+
+    /**
+     * @brief Recalculate the visible region and the kept pages after the view
+     * changed. Only called by the render thread.
+     */
+    void update_viewport();
 
     /// The window containing the program graphics, and where input is
     /// retrieved.
     std::unique_ptr<sf::RenderWindow> m_window;
 
-    /// Texture for drawing onto. A large pixel canvas of some width and height
-    /// that can be updated.
-    sf::RenderTexture m_texture;
+    /// Every page texture, kept or free.
+    std::vector<std::unique_ptr<Page>> m_pages;
 
-    /// Mutex for prevent concurrent use of the texture and window.
-    std::mutex m_mutex;
+    /// The kept pages by level and page coordinates.
+    std::unordered_map<std::uint64_t, Page*> m_resident;
 
-    /// The texture is frozen at a certain point captured by this sprite object.
-    /// After the texture image is captured we can make some transformations and
-    /// draw it into the world space.
+    /// A page of dead tiles at one level of detail, drawn over reset pages.
+    sf::RenderTexture m_template;
+
+    /// The level of detail of the template, or -1 before it is drawn.
+    int m_template_level;
+
+    /// Draws each page into the window, transformed to its place in the world
+    /// space.
     sf::Sprite m_sprite;
 
+    /// The level of detail of the kept pages.
+    int m_level;
+
+    /// The range of kept pages at the level, excluding the right and bottom.
+    int m_page_left;
+    int m_page_top;
+    int m_page_right;
+    int m_page_bottom;
+
+    /// The number of viewport updates, stamped on the pages each one keeps.
+    std::uint64_t m_updates;
+
     // The view of the world space. The view defines how the world space is
     // mapped to pixels in the window.
     sf::View m_view;
@@ -157,10 +378,39 @@ private:
     /// The pixel height of the window.
     std::atomic_int m_pixel_height;
 
+    /// The visible region of tiles, updated whenever the view changes.
+    std::atomic_int m_viewport_x;
+    std::atomic_int m_viewport_y;
+    std::atomic_int m_viewport_width;
+    std::atomic_int m_viewport_height;
+
+    /// The centre and size of the view in pixels of the texture, updated
+    /// whenever the view changes, to map pixels to tiles from other threads.
+    std::atomic<float> m_centre_x;
+    std::atomic<float> m_centre_y;
+    std::atomic<float> m_size_x;
+    std::atomic<float> m_size_y;
+
+    /// Commands posted to the render thread.
+    RingBuffer<Command, 1024> m_commands;
+
     /// Each element is either -1 for decreasing, 0 for maintaining, or 1 for
     /// increasing the position of the view, pseudo-velocity.
     sf::Vector2f m_moving;
 
+    /// The rasterizer draws offscreen frames exactly like the view.
+    friend class Rasterizer;
+
+    /// The tiles across each page at the finest level of detail.
+    static constexpr int s_page_tiles = 64;
+
+    /// The pages kept beyond each side of the view, ready for panning.
+    static constexpr int s_page_margin = 1;
+
+    /// The coarsest level of detail, where a page spans more tiles than any
+    /// game space.
+    static constexpr int s_page_levels = 24;
+
     /// Pixels surrounding each tile that are not part of the tile.
     static int s_padding;
 
@@ -1,8 +1,94 @@
+#include <iostream>
+
+#include "Benchmark.hpp"
+#include "BlockedEngine.hpp"
+#include "Client.hpp"
 #include "Controller.hpp"
+#include "Daemon.hpp"
+#include "Headless.hpp"
+#include "Options.hpp"
+#include "Replay.hpp"
+#include "Verifier.hpp"
 
 int main(int argc, char **argv)
 {
-    Controller controller {};
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        return 1;
+    }
+
+    if (!options.daemon.empty()) {
+        Daemon daemon(options.daemon, options.threads);
+        return daemon.run();
+    }
+
+    if (options.benchmark) {
+        Benchmark benchmark(options);
+        return benchmark.run();
+    }
+
+    if (options.verify) {
+        Verifier verifier(options);
+        return verifier.run();
+    }
+
+    if (!options.replay.empty()) {
+        Replay replay(options);
+        return replay.run();
+    }
+
+    if (options.headless) {
+        std::unique_ptr<Engine> engine;
+
+        if (!options.ltl.empty()) {
+            LtlRule rule;
+            if (!parse_ltl_rule(options.ltl, rule)) {
+                std::cerr << "The Larger than Life rule " << options.ltl << " is not valid.\n";
+                return 1;
+            }
+
+            engine = make_engine(rule, options.width, options.height, options.threads);
+            if (!engine) {
+                std::cerr << "The radius of " << options.ltl << " does not fit a "
+                          << options.width << "x" << options.height << " game space.\n";
+                return 1;
+            }
+        }
+        else if (options.engine.empty()) {
+            engine = make_engine(options.width, options.height);
+        }
+        else {
+            engine = make_engine(options.engine, options.width, options.height, options.threads);
+
+            if (engine && options.engine == "blocked")
+                static_cast<BlockedEngine&>(*engine).depth(options.depth);
+        }
+
+        if (!engine) {
+            std::cerr << "The " << options.engine << " engine is not available for a "
+                      << options.width << "x" << options.height << " game space.\n";
+            return 1;
+        }
+
+        Headless headless(options, std::move(engine));
+        return headless.run();
+    }
+
+    if (!options.connect.empty()) {
+        std::unique_ptr<Client> client = std::make_unique<Client>();
+
+        if (!client->connect(options.connect, options.connect_port)) {
+            std::cerr << "Failed to connect to " << options.connect << ":"
+                      << options.connect_port << ".\n";
+            return 1;
+        }
+
+        Controller controller(std::move(client));
+        controller.main();
+        return 0;
+    }
+
+    Controller controller {options.serve, options.journal};
     controller.main();
     return 0;
 }